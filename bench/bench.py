@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""Benchmark of med over the data/G*.txt graphs.
+
+Every data file is analysed in every output mode with both engines (the count mode doesn't depend on
+the engine, so it is run only once). Each run writes a profile (see the --profile option of med) and
+the throughput, the per-graph latencies and the peak RSS are taken from it. Each configuration is run
+several times and the run with the median time is reported.
+
+The results are compared with the stored baseline and the script fails (exit code 1) if any of them
+is worse than the baseline by more than the tolerance. Runs shorter than the minimal time are reported
+but not compared, they are dominated by noise. Use --update (or 'make bench-baseline') to store the
+current results as the new baseline after an intended change or on a different machine.
+"""
+
+import argparse
+import glob
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+MODES = ["or", "nd", "c", "n", "bc"]
+ENGINES = ["s", "b"]
+ENGINE_INDEPENDENT_MODES = ["n"]
+
+
+def percentile(histogram, count, fraction):
+    """Estimates a percentile from the power-of-two buckets of the profile (geometric interpolation
+    inside the bucket)."""
+    if count == 0:
+        return 0
+    rank = fraction * count
+    seen = 0
+    for bucket in histogram:
+        if seen + bucket["count"] >= rank:
+            high = bucket["below_ns"]
+            low = high // 2
+            position = (rank - seen) / bucket["count"]
+            return int(low * math.pow(high / low, position))
+        seen += bucket["count"]
+    return histogram[-1]["below_ns"]
+
+
+def run_once(binary, filename, mode, engine, workdir):
+    profile = os.path.join(workdir, "profile.json")
+    output = os.path.join(workdir, "output")
+    args = [binary, "-i", filename, "-m", mode, "-e", engine, "-o", output, "-u", profile]
+    process = subprocess.run(args, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    errors = process.stderr.decode()
+    if process.returncode != 0 or errors:
+        raise RuntimeError("{} failed: {}".format(" ".join(args), errors.strip()))
+
+    with open(profile) as file:
+        data = json.load(file)
+    graphs = data["graphs"]
+    seconds = data["total_ns"] / 1e9
+    return {
+        "graphs": graphs["count"],
+        "time_ms": round(seconds * 1e3, 3),
+        "graphs_per_second": round(graphs["count"] / seconds, 1) if seconds > 0 else 0.0,
+        "p50_us": round(percentile(graphs["histogram"], graphs["count"], 0.50) / 1e3, 1),
+        "p99_us": round(percentile(graphs["histogram"], graphs["count"], 0.99) / 1e3, 1),
+        "peak_rss_kb": data["peak_rss_kb"],
+    }
+
+
+def run(binary, filename, mode, engine, repeat, workdir):
+    results = [run_once(binary, filename, mode, engine, workdir) for _ in range(repeat)]
+    results.sort(key=lambda result: result["time_ms"])
+    return results[len(results) // 2]
+
+
+def compare(result, baseline, tolerance, min_time_ms):
+    """Returns the list of regressions of the result against the baseline."""
+    if baseline is None:
+        return []
+    if result["graphs"] != baseline["graphs"]:
+        return ["graphs {} (baseline {})".format(result["graphs"], baseline["graphs"])]
+    if max(result["time_ms"], baseline["time_ms"]) < min_time_ms:
+        return []
+
+    regressions = []
+    if result["graphs_per_second"] < baseline["graphs_per_second"] * (1 - tolerance):
+        regressions.append("graphs/s {} (baseline {})".format(result["graphs_per_second"], baseline["graphs_per_second"]))
+    for key in ["p50_us", "p99_us", "peak_rss_kb"]:
+        if result[key] > baseline[key] * (1 + tolerance):
+            regressions.append("{} {} (baseline {})".format(key, result[key], baseline[key]))
+    return regressions
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description="Benchmark of med over the data/G*.txt graphs.")
+    parser.add_argument("--binary", default=os.path.join(root, "bin", "med"))
+    parser.add_argument("--data", default=os.path.join(root, "data"))
+    parser.add_argument("--baseline", default=os.path.join(root, "bench", "baseline.json"))
+    parser.add_argument("--update", action="store_true", help="store the results as the new baseline")
+    parser.add_argument("--repeat", type=int, default=5, help="runs of each configuration (default 5)")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="allowed relative slowdown (default 0.25)")
+    parser.add_argument("--min-time", type=float, default=20.0, help="shorter runs (in ms) are not compared (default 20)")
+    options = parser.parse_args()
+
+    baseline = {}
+    if not options.update and os.path.exists(options.baseline):
+        with open(options.baseline) as file:
+            baseline = json.load(file)["results"]
+
+    results = {}
+    failed = False
+    print("{:<8} {:<4} {:<6} {:>7} {:>10} {:>12} {:>10} {:>10} {:>10}  {}".format(
+        "file", "mode", "engine", "graphs", "time ms", "graphs/s", "p50 us", "p99 us", "rss kB", "status"))
+
+    with tempfile.TemporaryDirectory() as workdir:
+        for filename in sorted(glob.glob(os.path.join(options.data, "G*.txt"))):
+            name = os.path.splitext(os.path.basename(filename))[0]
+            for mode in MODES:
+                for engine in ENGINES[:1] if mode in ENGINE_INDEPENDENT_MODES else ENGINES:
+                    key = "{}/{}/{}".format(name, mode, engine)
+                    result = run(options.binary, filename, mode, engine, options.repeat, workdir)
+                    results[key] = result
+
+                    if options.update:
+                        status = "stored"
+                    elif key not in baseline:
+                        status = "new"
+                    else:
+                        regressions = compare(result, baseline[key], options.tolerance, options.min_time)
+                        status = "REGRESSION: " + ", ".join(regressions) if regressions else "ok"
+                        failed = failed or bool(regressions)
+
+                    print("{:<8} {:<4} {:<6} {:>7} {:>10} {:>12} {:>10} {:>10} {:>10}  {}".format(
+                        name, mode, engine, result["graphs"], result["time_ms"], result["graphs_per_second"],
+                        result["p50_us"], result["p99_us"], result["peak_rss_kb"], status))
+
+    if options.update:
+        with open(options.baseline, "w") as file:
+            json.dump({"results": results}, file, indent=2, sort_keys=True)
+            file.write("\n")
+        print("baseline stored to " + options.baseline)
+    elif failed:
+        print("BENCHMARK FAILED: results are worse than the baseline by more than {:.0%}".format(options.tolerance))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
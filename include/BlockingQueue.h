@@ -0,0 +1,80 @@
+#ifndef MEDTESTER_BLOCKING_QUEUE_H_
+#define MEDTESTER_BLOCKING_QUEUE_H_
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+
+namespace MEDTester
+{
+
+/* Bounded FIFO queue shared between producer and consumer threads. Push blocks while the queue
+ * is full, pop blocks while it is empty. After close() no more items are accepted and pop returns
+ * false once the remaining items are consumed. */
+template <typename T> class BlockingQueue
+{
+public:
+    // Constructor and deconstructor:
+    BlockingQueue(size_t capacity);
+    ~BlockingQueue();
+
+    // Queue operations:
+    bool push(T item);
+    bool pop(T& item);
+    void close();
+
+private:
+    size_t mCapacity;
+    bool mClosed;
+    std::deque<T> mItems;
+    std::mutex mMutex;
+    std::condition_variable mNotFull;
+    std::condition_variable mNotEmpty;
+};
+
+
+template <typename T> BlockingQueue<T>::BlockingQueue(size_t capacity)
+{
+    mCapacity = capacity > 0 ? capacity : 1;
+    mClosed = false;
+}
+
+template <typename T> BlockingQueue<T>::~BlockingQueue() {}
+
+template <typename T> bool BlockingQueue<T>::push(T item)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mNotFull.wait(lock, [this] { return mClosed || mItems.size() < mCapacity; });
+    if (mClosed) return false;
+
+    mItems.push_back(std::move(item));
+    mNotEmpty.notify_one();
+    return true;
+}
+
+template <typename T> bool BlockingQueue<T>::pop(T& item)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mNotEmpty.wait(lock, [this] { return mClosed || !mItems.empty(); });
+    if (mItems.empty()) return false;
+
+    item = std::move(mItems.front());
+    mItems.pop_front();
+    mNotFull.notify_one();
+    return true;
+}
+
+template <typename T> void BlockingQueue<T>::close()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mClosed = true;
+    mNotFull.notify_all();
+    mNotEmpty.notify_all();
+}
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_BLOCKING_QUEUE_H_
@@ -0,0 +1,52 @@
+#ifndef MEDTESTER_CANONICAL_FORM_H_
+#define MEDTESTER_CANONICAL_FORM_H_
+
+#include "CubicGraph.h"
+
+#include <vector>
+#include <cstddef>
+
+
+namespace MEDTester
+{
+
+/* Canonical labelling of a cubic graph - isomorphic graphs get the same certificate (adjacency
+ * list in the canonical labelling) and different graphs get different ones. Vertices are split
+ * into classes by colour refinement and the remaining ties are broken by individualising each vertex
+ * of the first smallest class, the lexicographically smallest certificate of all the branches is
+ * the canonical one. Branches equivalent under automorphisms found on the way are skipped. Highly
+ * symmetric graphs can still have too many branches, then no certificate is computed (see
+ * isComputed). */
+class CanonicalForm
+{
+public:
+    // Constructor and deconstructor:
+    CanonicalForm(const MEDTester::CubicGraph& graph);
+    ~CanonicalForm();
+
+    // Getters:
+    const std::vector<int>& getCertificate() const;     // Sorted neighbours of canonical vertices 0, 1, ...
+    int getLabel(int vertex) const;                     // Canonical label of the vertex.
+    const std::vector<std::vector<int>>& getAutomorphisms() const;     // Found on the way, not all of them.
+
+    bool isComputed() const;
+
+private:
+    const MEDTester::CubicGraph& mGraph;
+    std::vector<int> mCertificate;
+    std::vector<int> mLabels;
+    std::vector<std::vector<int>> mAutomorphisms;
+    size_t mLeavesCount;
+    bool mComputed;
+
+    static const size_t MAX_LEAVES_COUNT;
+    static const size_t MAX_AUTOMORPHISMS_COUNT;
+
+    void refine(std::vector<int>& colors) const;
+    void search(const std::vector<int>& initialColors, std::vector<int>& sequence);
+    bool isEquivalent(int vertex, const std::vector<int>& explored, const std::vector<int>& sequence) const;
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_CANONICAL_FORM_H_
@@ -0,0 +1,143 @@
+#ifndef MEDTESTER_CDCL_SOLVER_H_
+#define MEDTESTER_CDCL_SOLVER_H_
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace MEDTester
+{
+
+/* Small conflict-driven clause learning SAT solver used when the program is built without the
+ * cryptominisat library. It implements only the part of the cryptominisat interface which is needed
+ * by SatSolver (with the same names), so SatSolver can be built with either of them: two watched
+ * literals with blockers, 1UIP learning with non-chronological backjumping, VSIDS with phase saving,
+ * Luby restarts, solving under assumptions and interruption from another thread. Clauses satisfied at the top level (for example the
+ * retired clauses of a pooled solver) and the less useful learnt clauses are removed at restarts. */
+class CdclSolver
+{
+public:
+    class Lit
+    {
+    public:
+        Lit() : mX(UINT32_MAX) {}
+        Lit(uint32_t var, bool isInverted) : mX(2*var + (isInverted ? 1 : 0)) {}
+
+        uint32_t var() const { return mX >> 1; }
+        bool sign() const { return mX & 1; }
+        uint32_t toInt() const { return mX; }
+        static Lit fromInt(uint32_t x) { Lit lit; lit.mX = x; return lit; }
+
+        Lit operator~() const { return fromInt(mX ^ 1); }
+        bool operator==(const Lit& other) const { return mX == other.mX; }
+        bool operator!=(const Lit& other) const { return mX != other.mX; }
+        bool operator<(const Lit& other) const { return mX < other.mX; }
+
+    private:
+        uint32_t mX;
+    };
+
+    enum class LBool : uint8_t
+    {
+        L_TRUE = 0,
+        L_FALSE = 1,
+        L_UNDEF = 2
+    };
+
+    // Constructor and deconstructor:
+    CdclSolver(void* config = nullptr, std::atomic<bool>* interrupt = nullptr);    // Config is ignored.
+    ~CdclSolver();
+
+    CdclSolver(const CdclSolver&) = delete;
+    CdclSolver& operator=(const CdclSolver&) = delete;
+
+    // Interface shared with CMSat::SATSolver:
+    void new_var();
+    void new_vars(uint32_t count);
+    uint32_t nVars() const;
+    bool add_clause(const std::vector<Lit>& lits);
+    LBool solve(const std::vector<Lit>* assumptions = nullptr);
+    const std::vector<LBool>& get_model() const;
+    void set_num_threads(unsigned int numThreads);      // The solver is single-threaded.
+    void set_max_confl(uint64_t maxConflicts);          // Limit of the following solve calls, then L_UNDEF is returned.
+    void set_default_polarity(bool polarity);           // Value tried first for each variable until it gets a saved phase.
+    uint64_t get_sum_conflicts() const;
+    uint64_t get_sum_decisions() const;
+    uint64_t get_sum_propagations() const;
+
+private:
+    struct Watcher
+    {
+        uint32_t clause;
+        Lit blocker;
+    };
+
+    bool mOk;                                   // False once the clauses are unsatisfiable.
+    std::vector<LBool> mAssigns;
+    std::vector<int> mLevels;
+    std::vector<uint32_t> mReasons;
+    std::vector<bool> mPhases;
+    std::vector<uint8_t> mSeen;
+    std::vector<Lit> mTrail;
+    std::vector<int> mTrailLimits;
+    size_t mQueueHead;
+    std::vector<LBool> mModel;
+    std::vector<Lit> mAddedClause;
+
+    /* Clauses are stored in one array - a header (size, flags and LBD) followed by the literals. */
+    std::vector<uint32_t> mArena;
+    std::vector<uint32_t> mLearnts;
+    std::vector<std::vector<Watcher>> mWatches;     // Indexed by literal, triggered when it becomes false.
+    size_t mMaxLearnts;
+    size_t mSimplifiedTrailSize;
+
+    std::vector<double> mActivity;
+    double mVarInc;
+    std::vector<int> mHeap;
+    std::vector<int> mHeapIndex;
+
+    uint64_t mConflicts;                        // Statistics summed over all solve calls.
+    uint64_t mDecisions;
+    uint64_t mPropagations;
+    uint64_t mMaxConflicts;                     // Value of mConflicts at which solving stops.
+    bool mDefaultPolarity;
+    std::atomic<bool>* mInterrupt;              // Once set (from any thread), solving stops with L_UNDEF.
+
+    static const uint32_t NO_CLAUSE;
+
+    LBool value(Lit lit) const;
+    bool isInterrupted() const;
+    int decisionLevel() const;
+    void newDecisionLevel();
+    void enqueue(Lit lit, uint32_t reason);
+    void cancelUntil(int level);
+
+    uint32_t allocClause(const std::vector<Lit>& lits, bool learnt, uint32_t lbd);
+    void attachClause(uint32_t clause);
+    uint32_t clauseSize(uint32_t clause) const;
+    uint32_t* clauseLits(uint32_t clause);          // Literals as their integer codes.
+
+    uint32_t propagate();
+    void analyze(uint32_t conflict, std::vector<Lit>& learnt, int& backtrackLevel, uint32_t& lbd);
+    bool isRedundant(Lit lit);
+    LBool search(long conflictsLimit, const std::vector<Lit>& assumptions);
+    Lit pickBranchLit();
+
+    void simplify();
+    void reduceLearnts();
+    void collectGarbage();
+
+    void bumpVar(int var);
+    void heapInsert(int var);
+    void heapUp(int pos);
+    void heapDown(int pos);
+    int heapPop();
+
+    static double luby(double y, int x);
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_CDCL_SOLVER_H_
@@ -4,8 +4,10 @@
 #include "typedefs.h"
 
 #include <vector>
-#include <unordered_set>
+#include <utility>
+#include <cstdint>
 #include <iostream>
+#include <atomic>
 
 
 namespace MEDTester
@@ -16,13 +18,20 @@ class CubicGraph
 public:
     // Constructors and deconstructor:
     CubicGraph(const MEDTester::Matrix& adjList);
+    CubicGraph(const MEDTester::FlatAdjList& adjList);
     ~CubicGraph();
+    void assign(const MEDTester::FlatAdjList& adjList);     // Replaces the graph, the arrays are reused.
 
     // Getters:
     int getVerticesCount() const;
     int getEdgesCount() const;
-    MEDTester::Matrix getAdjList() const;
-    MEDTester::Matrix getAdjListIndices() const;
+    const MEDTester::FlatAdjList& getAdjList() const;
+    int getNeighbour(int vertex, int index) const;
+    int getReverseIndex(int vertex, int index) const;
+    int getIndex(int vertex, int neighbour) const;
+    int getEdgeId(int vertex, int index) const;
+    std::pair<int,int> getEdge(int edgeId) const;
+    std::pair<int,int> getEdgeSlot(int edgeId) const;
     MEDTester::Decomposition getDecomposition();
     int getDecompositionsCount();
     int getBridgesCount();
@@ -37,29 +46,68 @@ public:
     // Functions for checking properties of the graph:
     bool isDecomposable();
     bool isBridgeless();
+    static bool isBridgeless(const MEDTester::FlatAdjList& adjList);
+
+    // Stopping of the decomposition search from another thread (its result is not valid then):
+    void setInterrupt(const std::atomic<bool>* interrupt);
+    bool isInterrupted() const;
 
 private:
+    // Change made by one edge assignment in the decomposition search, so it can be undone:
+    struct AssignedEdge
+    {
+        int slot;                   // Position of the edge in mAdjList.
+        int attachedRoot;           // Root attached by joining two cycle fragments, -1 if none.
+        bool rankIncreased;
+        int leafVertices[2];        // Vertices which became double-star leaf vertices, -1 if none.
+    };
+
+    // Arrays of the traversals, shared by all graphs of one thread so they are allocated only once:
+    struct TraversalWorkspace
+    {
+        std::vector<uint64_t> visited;      // Bitmap of visited vertices.
+        std::vector<int> stack;
+        std::vector<int> parents;
+        std::vector<uint8_t> nextIndices;   // Next neighbour of each vertex on the stack to be tried.
+        std::vector<int> disc;              // Discovery time of each vertex in countBridges, 0 if not visited.
+        std::vector<int> low;
+
+        void reset(int verticesCount);
+        bool visit(int vertex);             // Marks the vertex, false if it was visited before.
+    };
+
     int mVerticesCount;
     int mEdgesCount;
-    MEDTester::Matrix mAdjList;
-    MEDTester::Matrix mAdjListIndices;
+    MEDTester::FlatAdjList mAdjList;
+    std::vector<uint8_t> mReverseIndices;
+    std::vector<int> mEdgeIds;
+    std::vector<int> mEdgeSlots;        // Position of the first occurrence of each edge in mAdjList.
     MEDTester::Decomposition mDecomposition;
+    std::vector<AssignedEdge> mAssignedEdges;
+    std::vector<int> mCycleParents;         // Union-find of the paths formed by cycle edges.
+    std::vector<uint8_t> mCycleParities;    // Parity of the path from a vertex to its parent.
+    std::vector<uint8_t> mCycleRanks;
+    std::vector<bool> mLeafVertices;
     bool mDecompositionDone;
     int mDecompositionsCount;
     int mBridgesCount;
     bool mAllBridgesFound;
+    const std::atomic<bool>* mInterrupt;
+    bool mInterrupted;
 
-    void dfsHelper(int vertex, std::vector<int>& vec, std::unordered_set<int>& visited) const;
+    static MEDTester::FlatAdjList toFlatAdjList(const MEDTester::Matrix& adjList);
+    static MEDTester::CubicGraph::TraversalWorkspace& getWorkspace();
 
-    void assignEdge(int vertex, unsigned int index, MEDTester::EdgeType type);
+    bool assignEdge(int vertex, unsigned int index, MEDTester::EdgeType type);
+    void undoEdges(size_t assignedCount);
+    bool joinCycleFragments(int u, int v, AssignedEdge& assigned);
+    int findCycleRoot(int vertex, int& parity) const;
+    bool isLeafVertex(int vertex) const;
     void generateDecomposition(int vertex, bool counting);
     void decompositionHelper(unsigned int index, std::vector<int>& vertices, bool counting);
 
-    bool checkCycles() const;
-    bool checkDoubleStars() const;
-
     void countBridges(bool findOnlyOne);
-    void countBridgesHelper(int vertex, int parent, std::vector<bool>& visited, std::vector<int>& disc, std::vector<int>& low, int *time, bool findOnlyOne);
+    static int countBridges(const MEDTester::FlatAdjList& adjList, bool findOnlyOne);
 };
 
 } // namespace MEDTester
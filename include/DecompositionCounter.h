@@ -0,0 +1,74 @@
+#ifndef MEDTESTER_DECOMPOSITION_COUNTER_H_
+#define MEDTESTER_DECOMPOSITION_COUNTER_H_
+
+#include "CubicGraph.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <utility>
+
+
+namespace MEDTester
+{
+
+/* Exact counting of MED decompositions by dynamic programming over a path decomposition of the
+ * graph. Vertices are processed one by one and the edges between processed and unprocessed
+ * vertices (the frontier) keep everything the rest of the graph needs to know - the type of each
+ * frontier edge, and for cycle edges which two of them are the ends of the same path and the parity
+ * of that path. Numbers of partial decompositions are summed over equal frontier states, so the
+ * running time depends on the width of the frontier, not on the number of decompositions. */
+class DecompositionCounter
+{
+public:
+    // Constructor and deconstructor:
+    DecompositionCounter(const MEDTester::CubicGraph& graph);
+    ~DecompositionCounter();
+
+    // Getters:
+    uint64_t getDecompositionsCount();
+
+private:
+    // Type of a frontier edge, including what it requires from the unprocessed endpoint:
+    enum FrontierType : uint32_t
+    {
+        MATCHING = 0,
+        STAR_CENTER = 1,
+        LEAF_FROM_CENTER = 2,       // Double-star leaf edge, the unprocessed endpoint must be a leaf vertex.
+        LEAF_FROM_LEAF = 3,         // Double-star leaf edge, the unprocessed endpoint must be a center vertex.
+        CYCLE = 4,
+        CYCLE_FROM_LEAF = 5         // Cycle edge from a leaf vertex, the other endpoint can't be a leaf vertex.
+    };
+
+    // Kind of a vertex given by the types of its edges (MCC, HCC or SHH):
+    enum VertexKind
+    {
+        MATCHING_VERTEX,
+        LEAF_VERTEX,
+        CENTER_VERTEX
+    };
+
+    /* Frontier edge is stored in one integer - the type in the lowest 3 bits, the parity of its
+     * path in the next bit and the position of the other end of the path in the remaining bits. */
+    typedef std::u32string FrontierState;
+
+    const MEDTester::CubicGraph& mGraph;
+    bool mCounted;
+    uint64_t mDecompositionsCount;
+
+    std::vector<int> getVertexOrder() const;
+    std::vector<int> getGreedyOrder(int root, std::pair<int, long>& width) const;
+    void count();
+    void processVertex(const std::vector<int>& inPositions, const std::vector<int>& outPositions,
+                       const std::vector<int>& newPositions, const std::unordered_map<MEDTester::DecompositionCounter::FrontierState, uint64_t>& states,
+                       std::unordered_map<MEDTester::DecompositionCounter::FrontierState, uint64_t>& nextStates, size_t nextFrontierSize) const;
+
+    static const int ORDER_ROOTS_COUNT;       // Number of vertices tried as the start of the order.
+
+    static bool isCompatible(uint32_t type, MEDTester::DecompositionCounter::VertexKind kind, MEDTester::EdgeType slotType);
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_DECOMPOSITION_COUNTER_H_
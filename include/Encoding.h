@@ -0,0 +1,17 @@
+#ifndef MEDTESTER_ENCODING_H_
+#define MEDTESTER_ENCODING_H_
+
+
+namespace MEDTester
+{
+
+// Encoding of the decomposition used by the SAT solver engine
+enum class Encoding
+{
+    ONE_HOT,
+    COMPACT
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_ENCODING_H_
@@ -0,0 +1,17 @@
+#ifndef MEDTESTER_ENGINE_H_
+#define MEDTESTER_ENGINE_H_
+
+
+namespace MEDTester
+{
+
+// Search used for graphs which are not decided by a 3-edge-coloring
+enum class Engine
+{
+    SAT_SOLVER,
+    BACKTRACKING
+};
+    
+} // namespace MEDTester
+
+#endif // MEDTESTER_ENGINE_H_
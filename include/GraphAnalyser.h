@@ -3,17 +3,36 @@
 
 #include "typedefs.h"
 #include "OutputMode.h"
+#include "Engine.h"
+#include "InputFormat.h"
+#include "Encoding.h"
 #include "Parser.h"
+#include "InputReader.h"
+#include "ResultCache.h"
+#include "OutputWriter.h"
+#include "Profiler.h"
+#include "Portfolio.h"
+#include "CubicGraph.h"
+#include "TaitColoring.h"
 
 #include <string>
-#include <unordered_map>
 #include <iostream>
 #include <exception>
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 
 namespace MEDTester
 {
 
+class SatSolverPool;
+class SatSolver;
+class Reducer;
+class CanonicalForm;
+
 class GraphAnalyser
 {
 public:
@@ -43,7 +62,7 @@ public:
 
     // Constructors and deconstructor:
     GraphAnalyser(MEDTester::Parser& parser);
-    GraphAnalyser(const std::string& inputFilename, const std::string& outputFilename, MEDTester::OutputMode outputMode, bool onlyBridgeless, bool showTime);
+    GraphAnalyser(const std::string& inputFilename, const std::string& outputFilename, MEDTester::OutputMode outputMode, bool onlyBridgeless, bool showTime, unsigned int threadsCount, bool useSolverPool, bool showStats, MEDTester::Engine engine, bool useCache, unsigned int shardIndex, unsigned int shardsCount, MEDTester::InputFormat inputFormat, bool streaming, bool withAdjacency, unsigned int checkpointInterval, bool resume, const std::string& profileFilename, unsigned int portfolioThreshold, MEDTester::Encoding encoding, bool reduce);
     ~GraphAnalyser();
 
     // Standard analysis function
@@ -56,22 +75,137 @@ private:
     MEDTester::OutputMode mOutputMode;
     bool mOnlyBridgeless;
     bool mShowTime;
+    unsigned int mThreadsCount;
+    bool mUseSolverPool;
+    bool mShowStats;
+    MEDTester::Engine mEngine;
+    bool mUseCache;
+    unsigned int mShardIndex;
+    unsigned int mShardsCount;
+    MEDTester::InputFormat mInputFormat;
+    bool mStreaming;
+    bool mWithAdjacency;
+    unsigned int mCheckpointInterval;       // In seconds, 0 = no checkpoints.
+    bool mResume;
+    std::string mProfileFilename;
+    unsigned int mPortfolioThreshold;       // In milliseconds, 0 = no portfolio.
+    MEDTester::Encoding mEncoding;
+    bool mReduce;
+
+    // Graph read from the input, waiting to be analysed by a worker:
+    struct GraphTask
+    {
+        long index;         // Index of the graph among the analysed ones (starting from 0).
+        int position;       // Position of the graph in the input (starting from 0).
+        size_t inputOffset; // Offset in the input after the graph.
+        int graphNum;
+        MEDTester::FlatAdjList adjList;
+    };
+
+    // Output of one graph, waiting to be written in the input order:
+    struct GraphResult
+    {
+        std::string output;
+        int position;
+        size_t inputOffset;
+    };
+
+    // Progress of the analysis saved to (or loaded from) the checkpoint file:
+    struct Checkpoint
+    {
+        bool loaded = false;
+        size_t inputOffset = 0;     // Offset in the input after the last processed graph.
+        int position = 0;           // Number of processed graphs (position of the next one).
+        int graphCount = -1;        // Number of graphs from the header of the text input.
+        size_t outputOffset = 0;    // Length of the output of the processed graphs.
+        std::chrono::steady_clock::time_point nextSave = std::chrono::steady_clock::now();
+    };
+
+    // Numbers of graphs resolved by each stage of the analysis:
+    struct StageStats
+    {
+        long skipped = 0;           // Graphs with a bridge (only with the bridgeless option).
+        long coloring = 0;          // Graphs decided by finding a 3-edge-coloring.
+        long cached = 0;            // Graphs answered from the cache (isomorphic to an analysed one).
+        long solver = 0;            // Graphs that needed the full decomposition search.
+        long raced = 0;             // Solved graphs which reached the portfolio threshold.
+        long won = 0;               // Raced graphs decided by another search than the selected engine.
+        long reduced = 0;           // Solved graphs with a piece cut off (only with the reduce option).
+        long reducedVertices = 0;   // Vertices of the reduced graphs.
+        long kernelVertices = 0;    // Vertices left to the SAT solver in the reduced graphs.
+    };
 
-    // Analysis functions for each output mode:
-    void onlyResultMode(std::istream& in, std::ostream& out) const;
-    void notDecomposableMode(std::istream& in, std::ostream& out) const;
-    void coloringMode(std::istream& in, std::ostream& out) const;
-    void countMode(std::istream& in, std::ostream& out) const;
+    // State kept by each analysing thread from one graph to another:
+    struct WorkerContext
+    {
+        StageStats stats;
+        std::unique_ptr<MEDTester::SatSolverPool> solverPool;
+        MEDTester::ResultCache* cache = nullptr;        // Shared by all threads.
+        std::unique_ptr<MEDTester::Profiler> profiler;  // Null if profiling is off.
+        std::unique_ptr<MEDTester::Portfolio> portfolio;    // Null if the portfolio is off.
+
+        // Current graph, its coloring and decomposition, reused from one graph to another:
+        MEDTester::CubicGraph graph{MEDTester::FlatAdjList()};
+        MEDTester::TaitColoring tait{graph};
+        MEDTester::Decomposition decomposition;
+
+        WorkerContext() = default;
+        WorkerContext(const WorkerContext&) = delete;   // The coloring refers to the graph of its context.
+    };
+
+    // Serial and parallel driver of the analysis (both produce the same output):
+    void analyzeSerial(MEDTester::InputReader& in, MEDTester::OutputWriter& out, MEDTester::ResultCache* cache, StageStats& stats, Checkpoint& checkpoint, MEDTester::Profiler* profiler) const;
+    void analyzeParallel(MEDTester::InputReader& in, MEDTester::OutputWriter& out, MEDTester::ResultCache* cache, StageStats& stats, Checkpoint& checkpoint, MEDTester::Profiler* profiler) const;
+    void analyzeGraph(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const;
+    bool isOwnedGraph(int position) const;
+    int readHeader(MEDTester::InputReader& in) const;
+    bool nextGraph(MEDTester::InputReader& in, int position, int graphCount, int& graphNum, MEDTester::FlatAdjList* adjList) const;
+    void writeHeader(MEDTester::OutputWriter& out) const;
+    void initContext(WorkerContext& context, MEDTester::ResultCache* cache) const;
+    void writeStats(const StageStats& stats, std::ostream& out) const;
+    std::string getCheckpointFilename() const;
+    void loadCheckpoint(Checkpoint& checkpoint) const;
+    void saveCheckpoint(Checkpoint& checkpoint, size_t inputOffset, int position, MEDTester::OutputWriter& out, bool force) const;
+    std::unique_ptr<MEDTester::SatSolver> createSolver(WorkerContext& context, const MEDTester::CubicGraph& graph) const;
+    std::unique_ptr<MEDTester::Reducer> createReducer(WorkerContext& context, const MEDTester::CubicGraph& graph, std::atomic<bool>* interrupt) const;
+    MEDTester::CubicGraph& loadGraph(WorkerContext& context, const MEDTester::FlatAdjList& adjList) const;
+    bool hasBridge(WorkerContext& context, const MEDTester::FlatAdjList& adjList) const;
+    bool isColorable(WorkerContext& context, MEDTester::TaitColoring& tait) const;
+    bool runEngine(WorkerContext& context, MEDTester::CubicGraph& graph, MEDTester::Decomposition* decomposition) const;
+    bool isDecomposable(WorkerContext& context, MEDTester::CubicGraph& graph) const;
+    bool findDecomposition(WorkerContext& context, MEDTester::CubicGraph& graph, MEDTester::Decomposition& decomposition) const;
+    bool findCachedResult(WorkerContext& context, const MEDTester::CubicGraph& graph, std::unique_ptr<MEDTester::CanonicalForm>& form, MEDTester::ResultCache::Result& result) const;
+    void insertCachedResult(WorkerContext& context, const MEDTester::CubicGraph& graph, const std::unique_ptr<MEDTester::CanonicalForm>& form, const MEDTester::ResultCache::Result& result) const;
+
+    // Analysis functions for each output mode (each one handles a single graph):
+    void onlyResultMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const;
+    void notDecomposableMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const;
+    void coloringMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const;
+    void countMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const;
+    void binaryColoringMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const;
 
     // Private static constants, messages and utility functions:
-    static const std::unordered_map<MEDTester::EdgeType, std::string> EDGE_TYPE_CHAR;
     static inline std::string WRONG_INPUT_FORMAT_MESSAGE(const std::string& additionalInfo);
     static inline std::string INPUT_FILE_DOES_NOT_EXIST_MESSAGE(const std::string& filename);
     static inline std::string CANNOT_OPEN_FILE_MESSAGE(const std::string& filename);
     static inline std::string OUTPUT_MODE_NOT_IMPLEMENTED(const std::string& mode);
-
-    static int getInt(std::istream& in, const std::string& what);
-    static MEDTester::Matrix getAdjList(std::istream& in, int graphNum, bool errorCheck);
+    static inline std::string CHECKPOINT_NEEDS_OUTPUT_FILE_MESSAGE();
+    static inline std::string CANNOT_RESUME_MESSAGE(const std::string& filename);
+    static inline std::string INVALID_CHECKPOINT_MESSAGE(const std::string& filename);
+
+    static const unsigned int DEFAULT_CHECKPOINT_INTERVAL;
+    static const std::string CHECKPOINT_FILE_SUFFIX;
+    static const std::string CHECKPOINT_FILE_HEADER;
+
+    static int getInt(MEDTester::InputReader& in, const std::string& what);
+    static void getAdjList(MEDTester::InputReader& in, int graphNum, MEDTester::FlatAdjList& adjList, bool errorCheck);
+    static void skipAdjList(MEDTester::InputReader& in, int graphNum);
+    static void getGraph6AdjList(MEDTester::InputReader& in, int graphNum, MEDTester::FlatAdjList& adjList);
+    static void skipGraph6(MEDTester::InputReader& in);
+    static void getMulticodeAdjList(MEDTester::InputReader& in, int graphNum, MEDTester::FlatAdjList& adjList);
+    static void skipMulticode(MEDTester::InputReader& in, int graphNum);
+    static void addEdge(MEDTester::FlatAdjList& adjList, int u, int v, int graphNum);
+    static void checkDegrees(const MEDTester::FlatAdjList& adjList, int graphNum);
 };
 
 } // namespace MEDTester
@@ -0,0 +1,17 @@
+#ifndef MEDTESTER_INPUT_FORMAT_H_
+#define MEDTESTER_INPUT_FORMAT_H_
+
+
+namespace MEDTester
+{
+
+enum class InputFormat
+{
+    TEXT,
+    GRAPH6,
+    MULTICODE
+};
+    
+} // namespace MEDTester
+
+#endif // MEDTESTER_INPUT_FORMAT_H_
@@ -0,0 +1,67 @@
+#ifndef MEDTESTER_INPUT_READER_H_
+#define MEDTESTER_INPUT_READER_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace MEDTester
+{
+
+/* Reader of whitespace separated integers (or raw bytes of binary formats). Regular files are
+ * memory-mapped and scanned in place, other inputs (standard input, pipes) are read through a fixed
+ * size buffer which is refilled whenever it runs out, so the memory usage doesn't depend on the
+ * input size. */
+class InputReader
+{
+public:
+    // Constructors and deconstructor:
+    InputReader();                                  // Reads standard input.
+    InputReader(const std::string& filename);
+    ~InputReader();
+
+    InputReader(const InputReader&) = delete;
+    InputReader& operator=(const InputReader&) = delete;
+
+    // State of the reader:
+    bool isOpen() const;
+    bool isMapped() const;
+    size_t getOffset() const;                       // Number of bytes consumed so far.
+    bool seek(size_t offset);                       // Only before reading, fails on pipes.
+
+    // Reading functions:
+    bool nextInt(int& x);
+    bool skipInts(size_t count);                    // Skips tokens without converting (or checking) them.
+    bool atEnd();
+
+    bool nextByte(uint8_t& x);
+    bool peekByte(uint8_t& x);
+    bool skipPrefix(const std::string& prefix);     // Skips the prefix if the input continues with it.
+
+private:
+    int mFd;
+    bool mOwnsFd;
+    bool mMapped;
+    bool mEof;
+
+    char* mMappedData;
+    size_t mMappedLength;
+    std::vector<char> mBuffer;
+
+    const char* mPos;
+    const char* mEnd;
+    size_t mConsumedBefore;                         // Bytes consumed before the current buffer.
+
+    static const size_t BUFFER_SIZE;
+
+    void init();
+    bool refill();
+    bool ensure(size_t count);
+    bool skipWhitespace();
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_INPUT_READER_H_
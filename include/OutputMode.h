@@ -11,7 +11,8 @@ enum class OutputMode
     NOT_DECOMPOSABLE,
     NOT_DECOMPOSABLE_BRIDGELESS,
     COLORING,
-    COUNT
+    COUNT,
+    BINARY_COLORING
 };
     
 } // namespace MEDTester
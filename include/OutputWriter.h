@@ -0,0 +1,61 @@
+#ifndef MEDTESTER_OUTPUT_WRITER_H_
+#define MEDTESTER_OUTPUT_WRITER_H_
+
+#include "typedefs.h"
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace MEDTester
+{
+
+/* Formats the results into a reusable byte buffer. Integers are converted by hand and edge types
+ * by a lookup table, so writing a result costs no allocations and no stream formatting. The buffer
+ * is written to the sink in large blocks (when it is full or on flush), a writer without a sink
+ * only collects the output, which is then taken by takeBuffer (the buffer keeps its capacity). */
+class OutputWriter
+{
+public:
+    // Constructors and deconstructor:
+    OutputWriter();                                 // Collects the output in memory.
+    OutputWriter(std::ostream& sink, size_t offset = 0);     // Offset = length of the output already in the sink.
+    ~OutputWriter();                                // Flushes the rest of the output.
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    // Writing functions:
+    void write(char c);
+    void write(const char* text);
+    void write(const std::string& text);
+    void writeInt(long long x);
+    void writeInt(long long x, int width);          // Right-aligned, padded with spaces.
+    void writeUnsigned(uint64_t x);
+    void writeEdgeType(MEDTester::EdgeType type);
+    void writeBytes(const void* data, size_t size);
+    void writeUInt32(uint32_t x);                   // Binary, little-endian.
+
+    size_t getOffset() const;                       // Length of the whole output (including the buffer).
+
+    // Buffer handling:
+    void flush();                                   // Writes the buffer to the sink and flushes it.
+    std::string takeBuffer();                       // Returns and clears the collected output (without a sink).
+
+private:
+    std::ostream* mSink;
+    std::string mBuffer;
+    size_t mOffset;                                 // Length of the output passed to the sink.
+
+    static const size_t BUFFER_SIZE;
+    static const char EDGE_TYPE_CHAR[];
+
+    void checkSize();
+    static size_t formatUnsigned(uint64_t x, char* end);
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_OUTPUT_WRITER_H_
@@ -2,9 +2,13 @@
 #define MEDTESTER_PARSER_H_
 
 #include "OutputMode.h"
+#include "Engine.h"
+#include "InputFormat.h"
+#include "Encoding.h"
 
 #include <string>
 #include <vector>
+#include <utility>
 #include <exception>
 
 namespace MEDTester
@@ -50,15 +54,50 @@ public:
     static const MEDTester::Parser::OptionInfo<MEDTester::OutputMode> OUTPUT_MODE_OPTION_INFO;
     static const MEDTester::Parser::OptionInfo<bool> ONLY_BRIDGELESS_OPTION_INFO;
     static const MEDTester::Parser::OptionInfo<bool> SHOW_TIME_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<unsigned int> THREADS_COUNT_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<bool> SOLVER_POOL_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<bool> SHOW_STATS_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<MEDTester::Engine> ENGINE_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<bool> USE_CACHE_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<std::pair<unsigned int, unsigned int>> SHARD_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<MEDTester::InputFormat> INPUT_FORMAT_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<bool> STREAMING_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<bool> WITH_ADJACENCY_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<unsigned int> CHECKPOINT_INTERVAL_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<bool> RESUME_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<std::string> PROFILE_FILENAME_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<unsigned int> PORTFOLIO_THRESHOLD_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<MEDTester::Encoding> ENCODING_OPTION_INFO;
+    static const MEDTester::Parser::OptionInfo<bool> REDUCE_OPTION_INFO;
 
     // Mode infos:
     static const MEDTester::Parser::ModeInfo<MEDTester::OutputMode> ONLY_RESULT_MODE_INFO;
     static const MEDTester::Parser::ModeInfo<MEDTester::OutputMode> NOT_DECOMPOSABLE_MODE_INFO;
     static const MEDTester::Parser::ModeInfo<MEDTester::OutputMode> COLORING_MODE_INFO;
     static const MEDTester::Parser::ModeInfo<MEDTester::OutputMode> COUNT_MODE_INFO;
+    static const MEDTester::Parser::ModeInfo<MEDTester::OutputMode> BINARY_COLORING_MODE_INFO;
 
     static const std::vector<MEDTester::Parser::ModeInfo<MEDTester::OutputMode>> AVAILABLE_OUTPUTMODES;
 
+    // Engine infos:
+    static const MEDTester::Parser::ModeInfo<MEDTester::Engine> SAT_ENGINE_INFO;
+    static const MEDTester::Parser::ModeInfo<MEDTester::Engine> BACKTRACKING_ENGINE_INFO;
+
+    static const std::vector<MEDTester::Parser::ModeInfo<MEDTester::Engine>> AVAILABLE_ENGINES;
+
+    // Input format infos:
+    static const MEDTester::Parser::ModeInfo<MEDTester::InputFormat> TEXT_FORMAT_INFO;
+    static const MEDTester::Parser::ModeInfo<MEDTester::InputFormat> GRAPH6_FORMAT_INFO;
+    static const MEDTester::Parser::ModeInfo<MEDTester::InputFormat> MULTICODE_FORMAT_INFO;
+
+    static const std::vector<MEDTester::Parser::ModeInfo<MEDTester::InputFormat>> AVAILABLE_INPUT_FORMATS;
+
+    // Encoding infos:
+    static const MEDTester::Parser::ModeInfo<MEDTester::Encoding> ONE_HOT_ENCODING_INFO;
+    static const MEDTester::Parser::ModeInfo<MEDTester::Encoding> COMPACT_ENCODING_INFO;
+
+    static const std::vector<MEDTester::Parser::ModeInfo<MEDTester::Encoding>> AVAILABLE_ENCODINGS;
+
     // Help speciefier:
     static const std::string HELP_SPECIFIER;
 
@@ -74,6 +113,22 @@ public:
     MEDTester::OutputMode getOutputMode() const;
     bool getOnlyBridgeless() const;
     bool getShowTime() const;
+    unsigned int getThreadsCount() const;
+    bool getUseSolverPool() const;
+    bool getShowStats() const;
+    MEDTester::Engine getEngine() const;
+    bool getUseCache() const;
+    unsigned int getShardIndex() const;
+    unsigned int getShardsCount() const;
+    MEDTester::InputFormat getInputFormat() const;
+    bool getStreaming() const;
+    bool getWithAdjacency() const;
+    unsigned int getCheckpointInterval() const;
+    bool getResume() const;
+    std::string getProfileFilename() const;
+    unsigned int getPortfolioThreshold() const;
+    MEDTester::Encoding getEncoding() const;
+    bool getReduce() const;
 
     void setArgumentRange(char** begin, char** end);
     void setInputFilename(const std::string& filename);
@@ -81,6 +136,21 @@ public:
     void setOutputMode(MEDTester::OutputMode outputMode);
     void setOnlyBridgeless(bool onlyBridgeless);
     void setShowTime(bool showTime);
+    void setThreadsCount(unsigned int threadsCount);
+    void setUseSolverPool(bool useSolverPool);
+    void setShowStats(bool showStats);
+    void setEngine(MEDTester::Engine engine);
+    void setUseCache(bool useCache);
+    void setShard(unsigned int shardIndex, unsigned int shardsCount);
+    void setInputFormat(MEDTester::InputFormat inputFormat);
+    void setStreaming(bool streaming);
+    void setWithAdjacency(bool withAdjacency);
+    void setCheckpointInterval(unsigned int checkpointInterval);
+    void setResume(bool resume);
+    void setProfileFilename(const std::string& filename);
+    void setPortfolioThreshold(unsigned int portfolioThreshold);
+    void setEncoding(MEDTester::Encoding encoding);
+    void setReduce(bool reduce);
 
     // Static and nonstatic parsing tools:
     static void checkSyntax(char** begin, char** end);
@@ -97,6 +167,21 @@ public:
     bool parseOutputMode();
     bool parseOnlyBridgeless();
     bool parseShowTime();
+    bool parseThreadsCount();
+    bool parseUseSolverPool();
+    bool parseShowStats();
+    bool parseEngine();
+    bool parseUseCache();
+    bool parseShard();
+    bool parseInputFormat();
+    bool parseStreaming();
+    bool parseWithAdjacency();
+    bool parseCheckpointInterval();
+    bool parseResume();
+    bool parseProfileFilename();
+    bool parsePortfolioThreshold();
+    bool parseEncoding();
+    bool parseReduce();
 
     void parseAll();
 
@@ -114,6 +199,22 @@ private:
     MEDTester::OutputMode mOutputMode;
     bool mShowTime;
     bool mOnlyBridgeless;
+    unsigned int mThreadsCount;
+    bool mUseSolverPool;
+    bool mShowStats;
+    MEDTester::Engine mEngine;
+    bool mUseCache;
+    unsigned int mShardIndex;
+    unsigned int mShardsCount;
+    MEDTester::InputFormat mInputFormat;
+    bool mStreaming;
+    bool mWithAdjacency;
+    unsigned int mCheckpointInterval;   // In seconds, 0 = no checkpoints.
+    bool mResume;
+    std::string mProfileFilename;        // If empty, no profile is written.
+    unsigned int mPortfolioThreshold;   // In milliseconds, 0 = no portfolio.
+    MEDTester::Encoding mEncoding;
+    bool mReduce;
 
     // Private static constants, messages and utility functions:
     static const std::string INVALID_ARGUMENT_RANGE_MESSAGE;
@@ -121,6 +222,11 @@ private:
     static inline std::string DOUBLE_OPTION_MESSAGE(const std::string& option);
     static inline std::string EXPECTED_OPTION_ARGUMENT_MESSAGE(const std::string& option);
     static inline std::string UNKNOWN_OUTPUT_MODE_MESSAGE(const std::string& mode);
+    static inline std::string UNKNOWN_ENGINE_MESSAGE(const std::string& engine);
+    static inline std::string INVALID_NUMBER_MESSAGE(const std::string& option, const std::string& value);
+    static inline std::string INVALID_SHARD_MESSAGE(const std::string& value);
+    static inline std::string UNKNOWN_INPUT_FORMAT_MESSAGE(const std::string& format);
+    static inline std::string UNKNOWN_ENCODING_MESSAGE(const std::string& encoding);
 
     static std::string formatText(const std::string& text, size_t indent, size_t width);
     static std::string joinToString(std::vector<std::string> list, const std::string& prefix, const std::string& suffix, const std::string& separator);
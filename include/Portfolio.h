@@ -0,0 +1,88 @@
+#ifndef MEDTESTER_PORTFOLIO_H_
+#define MEDTESTER_PORTFOLIO_H_
+
+#include "typedefs.h"
+#include "Engine.h"
+#include "Encoding.h"
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+
+namespace MEDTester
+{
+
+class CubicGraph;
+
+/* Races several searches on graphs which take too long. The search of the selected engine runs in
+ * the calling thread and if it doesn't decide the graph within the threshold, the other searches
+ * (contestants) join it - the other engine and a SAT solver with the other encoding and the opposite
+ * default polarity (with more threads if cryptominisat is used). The first answer wins and the other searches are
+ * stopped by a shared interrupt flag. Contestants run in threads kept by the portfolio, which wait
+ * on a condition variable otherwise, so graphs decided before the threshold cost only a few locks.
+ * Each analysing thread should have its own portfolio. */
+class Portfolio
+{
+public:
+    // Search of the selected engine, returns false if it was stopped by the flag from getInterrupt:
+    typedef std::function<bool(bool& decomposable, MEDTester::Decomposition* decomposition)> Search;
+
+    // Outcome of one graph:
+    struct Result
+    {
+        bool decomposable = false;
+        bool raced = false;         // The threshold passed and the contestants were started.
+        bool won = false;           // The graph was decided by a contestant.
+    };
+
+    // Constructor and deconstructor:
+    Portfolio(MEDTester::Engine engine, MEDTester::Encoding encoding, unsigned int thresholdMillis, unsigned int satThreadsCount);
+    ~Portfolio();
+
+    Portfolio(const Portfolio&) = delete;
+    Portfolio& operator=(const Portfolio&) = delete;
+
+    // The decomposition is found only if it is not null:
+    MEDTester::Portfolio::Result solve(const MEDTester::CubicGraph& graph, const MEDTester::Portfolio::Search& search, MEDTester::Decomposition* decomposition);
+    std::atomic<bool>* getInterrupt();
+
+private:
+    MEDTester::Engine mEngine;
+    MEDTester::Encoding mEncoding;
+    std::chrono::milliseconds mThreshold;
+    unsigned int mSatThreadsCount;
+
+    // State of the current graph shared with the contestants (guarded by mMutex):
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    uint64_t mGeneration;                   // Number of the current graph.
+    const MEDTester::CubicGraph* mGraph;
+    bool mWithDecomposition;
+    std::chrono::steady_clock::time_point mDeadline;
+    bool mSearchRunning;                    // The search of the selected engine hasn't returned yet.
+    int mRunningCount;                      // Number of contestants running.
+    int mStartedCount;
+    bool mDecided;
+    bool mDecomposable;
+    MEDTester::Decomposition mDecomposition;
+    bool mStopping;
+
+    std::atomic<bool> mInterrupt;
+    std::vector<std::thread> mContestants;
+
+    static const int CONTESTANTS_COUNT;
+    static const std::chrono::milliseconds INTERRUPT_REPEAT;
+
+    void runContestants(int contestant);
+    bool runContestant(int contestant, const MEDTester::CubicGraph& graph, bool withDecomposition, bool& decomposable, MEDTester::Decomposition& decomposition);
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_PORTFOLIO_H_
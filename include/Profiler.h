@@ -0,0 +1,93 @@
+#ifndef MEDTESTER_PROFILER_H_
+#define MEDTESTER_PROFILER_H_
+
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace MEDTester
+{
+
+/* Collects the time spent in each phase of the analysis, the latency of whole graphs and the
+ * statistics of the SAT solver. Each thread fills its own profiler (no locking) and they are merged
+ * at the end. Latencies are kept in histograms with power-of-two buckets, so the memory usage
+ * doesn't depend on the number of graphs, only the slowest graphs are remembered individually. */
+class Profiler
+{
+public:
+    // Phases of the analysis of one graph:
+    enum Phase
+    {
+        PARSING,
+        BRIDGES,
+        COLORING,
+        CACHE,
+        ENCODING,
+        SOLVING,
+        OUTPUT,
+        PHASES_COUNT
+    };
+
+    // Measures one phase from the construction to the destruction (does nothing without a profiler):
+    class Timer
+    {
+    public:
+        Timer(MEDTester::Profiler* profiler, MEDTester::Profiler::Phase phase);
+        ~Timer();
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        MEDTester::Profiler* mProfiler;
+        MEDTester::Profiler::Phase mPhase;
+        std::chrono::steady_clock::time_point mStart;
+    };
+
+    // Constructor and deconstructor:
+    Profiler();
+    ~Profiler();
+
+    // Recording functions:
+    void addPhaseTime(MEDTester::Profiler::Phase phase, uint64_t nanos);
+    void addGraphTime(int graphNum, uint64_t nanos);
+    void addSatStats(uint64_t conflicts, uint64_t decisions, uint64_t propagations);
+    void merge(const MEDTester::Profiler& other);
+
+    // Machine-readable summary:
+    void writeJson(std::ostream& out, uint64_t totalNanos) const;
+
+private:
+    struct Histogram
+    {
+        uint64_t count = 0;
+        uint64_t totalNanos = 0;
+        uint64_t maxNanos = 0;
+        std::vector<uint64_t> buckets;              // Bucket k holds latencies below 2^(k+1) ns.
+
+        void add(uint64_t nanos);
+        void merge(const Histogram& other);
+        void writeJson(std::ostream& out) const;
+    };
+
+    Histogram mPhases[PHASES_COUNT];
+    Histogram mGraphs;
+    std::vector<std::pair<uint64_t, int>> mSlowestGraphs;     // Min-heap of (time, graph number).
+    uint64_t mConflicts;
+    uint64_t mDecisions;
+    uint64_t mPropagations;
+
+    static const size_t BUCKETS_COUNT;
+    static const size_t SLOWEST_GRAPHS_COUNT;
+    static const char* const PHASE_NAMES[PHASES_COUNT];
+
+    static uint64_t getPeakMemory();
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_PROFILER_H_
@@ -0,0 +1,163 @@
+#ifndef MEDTESTER_REDUCER_H_
+#define MEDTESTER_REDUCER_H_
+
+#include "typedefs.h"
+#include "CubicGraph.h"
+#include "SatSolver.h"
+
+#include <vector>
+#include <random>
+#include <atomic>
+#include <cstdint>
+
+
+namespace MEDTester
+{
+
+/* Decides graphs with small edge cuts piece by piece instead of in one SAT instance. Pieces are cut
+ * off along bridges and 2-edge-cuts, and triangles and squares are cut off too. Larger graphs are also
+ * cut along cyclic 3- and 4-edge-cuts, found by small max flows around each vertex. The compact encoding
+ * has only clauses within a vertex or an edge and its ends, so the rest of the graph sees a piece only
+ * through the states of its boundary edges - the edge type, the parity of a cycle edge and whether
+ * the inner end is a cycle vertex and has another double-star leaf edge. The states which can be
+ * extended into the piece (signatures) are enumerated by a SAT solver once and the piece is replaced
+ * by their table, a piece without signatures decides the graph. The rest (kernel) is solved with the
+ * tables, then the decomposition of each piece is found again with its boundary fixed to the
+ * signature selected by the enclosing solution. Later pieces can contain earlier ones, so a chain of
+ * blocks costs about the sum of their sizes instead of the product. A piece joining several earlier
+ * ones can have a large table, so the reduction stops before such a piece. */
+class Reducer
+{
+public:
+    // Constructor and deconstructor:
+    Reducer(const MEDTester::CubicGraph& graph, std::atomic<bool>* interrupt = nullptr);
+    ~Reducer();
+
+    Reducer(const Reducer&) = delete;
+    Reducer& operator=(const Reducer&) = delete;
+
+    // The graph is decided only if a piece was cut off, it should be given to a SAT solver otherwise:
+    bool isReduced() const;
+    bool isDecomposable() const;
+    bool isInterrupted() const;
+    MEDTester::Decomposition getDecomposition();
+    int getKernelVerticesCount() const;
+    const MEDTester::SatSolver::Stats& getStats() const;
+
+private:
+    // State of the inner end of a boundary edge:
+    enum State : uint8_t
+    {
+        MATCHING = 0,
+        STAR_CENTER = 1,
+        LEAF_AT_CYCLE = 2,          // Double-star leaf edge, the inner end is a cycle vertex.
+        LEAF_AT_CENTER = 3,         // Double-star leaf edge, the inner end is a double-star center.
+        CYCLE = 4                   // Plus 1 for odd parity and 2 if the inner end has a leaf edge.
+    };
+
+    struct Piece
+    {
+        std::vector<int> vertices;          // Vertices not in the nested pieces.
+        std::vector<int> nested;            // Pieces cut off earlier which are inside this one.
+        std::vector<int> boundary;          // Edges leaving the piece.
+        std::vector<int> innerSlots;        // Slot 3*v+i of the inner end of each boundary edge.
+        std::vector<std::vector<uint8_t>> signatures;
+        int parent = -1;                    // Piece which contains this one, -1 in the kernel.
+        int selected = -1;                  // Signature used by the decomposition.
+        bool isCycle = false;               // Triangle or square without chords.
+    };
+
+    // Candidate for the next piece, given by subtrees of the DFS tree of the current graph:
+    struct Candidate
+    {
+        int weight;                         // Number of kernel vertices in the piece.
+        int boundarySize;
+        int inside;                         // Root of the DFS subtree in the piece (-1 if none).
+        int outside;                        // Root of the DFS subtree not in it (-1 if none).
+        bool complement;                    // The piece is everything except the subtree inside.
+        std::vector<int> vertices;          // Vertices of a triangle or a square (in the order of the cycle) instead of subtrees.
+    };
+
+    // Side of a cyclic cut, kept until it is used or it is not a cut any more:
+    struct CutSide
+    {
+        int size;                           // Number of vertices in the side.
+        int cutSize;
+        std::vector<bool> vertices;
+    };
+
+    // Variables of one SAT instance - the kernel or one piece with its nested pieces:
+    struct Scope
+    {
+        std::vector<int> vertices;
+        std::vector<int> nested;
+        std::vector<int> edgeVars;          // First variable of each edge of the graph (-1 if not in the scope).
+        std::vector<int> rowVars;           // First signature variable of each nested piece.
+        std::vector<int> endVars;           // First end variable (inner end is a cycle vertex, has a leaf) of each nested piece.
+        std::vector<MEDTester::SatLit> boundaryCycleLits;   // Inner end of each boundary edge of the scope is a cycle vertex.
+        std::vector<MEDTester::SatLit> boundaryLeafLits;    // Inner end of each boundary edge of the scope has a leaf edge.
+    };
+
+    MEDTester::CubicGraph mGraph;
+    std::atomic<bool>* mInterrupt;
+    std::vector<Piece> mPieces;
+    std::vector<int> mOwners;               // Outermost piece containing a vertex (updated lazily), -1 in the kernel.
+    std::vector<int> mKernel;
+    bool mDecomposable;
+    bool mInterrupted;
+    MEDTester::Decomposition mDecomposition;
+    bool mDecompositionDone;
+    MEDTester::SatSolver::Stats mStats;
+    std::mt19937_64 mRandom;
+
+    // Workspace of the search for cuts, reused from one round to another:
+    std::vector<int> mNodes;                // Node of the current graph for each vertex.
+    std::vector<int> mAdjStart;
+    std::vector<std::pair<int, int>> mAdj;  // Neighbouring node and edge.
+    std::vector<int> mOrder;                // Position of each node in the DFS order (-1 if unvisited).
+    std::vector<int> mNodesInOrder;
+    std::vector<int> mParents;
+    std::vector<int> mParentEdges;
+    std::vector<int> mSubtreeSizes;
+    std::vector<int> mSubtreeWeights;
+    std::vector<uint64_t> mLabels;          // XOR of the random labels of non-tree edges leaving the subtree.
+    std::vector<int> mSlotEnds;             // Nested piece and boundary index of each slot, while a scope is built.
+    std::vector<bool> mCutSearched;         // Nodes searched for a cyclic cut around them.
+    std::vector<MEDTester::Reducer::CutSide> mCutSides;
+    std::vector<int> mDistances;
+    std::vector<int> mQueue;
+    std::vector<int8_t> mFlows;             // Flow of each edge from its first end to the second one.
+    std::vector<std::pair<int, int>> mPrevious;     // Node and edge by which an augmenting path reached each node.
+
+    static const int MAX_BOUNDARY_SIZE;
+    static const int MIN_CYCLIC_CUT_WEIGHT;
+    static const int MAX_SIGNATURES_COUNT;
+
+    Reducer(const MEDTester::CubicGraph& graph, int cycleLength);
+    static const std::vector<std::vector<uint8_t>>& getCycleSignatures(int length);
+    static std::vector<std::vector<uint8_t>> findCycleSignatures(int length);
+
+    void reduce();
+    int findOwner(int vertex);
+    void buildCurrentGraph();
+    bool findPiece(MEDTester::Reducer::Piece& piece);
+    void addSmallCycles(std::vector<MEDTester::Reducer::Candidate>& candidates, int totalWeight);
+    bool fillPiece(const std::vector<bool>& isMember, MEDTester::Reducer::Piece& piece) const;
+    bool findCyclicCut(MEDTester::Reducer::Piece& piece, int totalWeight, int maxWeight);
+    bool findCutAround(int x, std::vector<bool>& isMember, int& cutSize);
+    bool findSignatures(int id);
+    void solveKernel();
+    void liftDecomposition();
+
+    MEDTester::SatLit edgeLit(const MEDTester::Reducer::Scope& scope, int edge, MEDTester::CompactVar var, bool isInverted) const;
+    void buildScope(MEDTester::SatBackend& solver, MEDTester::Reducer::Scope& scope, const std::vector<int>& boundary, const std::vector<int>& innerSlots);
+    void addEnd(const MEDTester::Reducer::Scope& scope, int slot, MEDTester::SatLit& cycleVertex, std::vector<MEDTester::SatLit>& leaves) const;
+    std::vector<MEDTester::SatLit> stateLits(const MEDTester::Reducer::Scope& scope, int edge, MEDTester::SatLit cycleVertex, MEDTester::SatLit hasLeaf, uint8_t state) const;
+    uint8_t readState(const MEDTester::Reducer::Scope& scope, const std::vector<MEDTester::SatValue>& model, int edge, MEDTester::SatLit cycleVertex, MEDTester::SatLit hasLeaf) const;
+    MEDTester::SatValue solve(MEDTester::SatBackend& solver, const std::vector<MEDTester::SatLit>* assumptions = nullptr);
+    void readSolution(const MEDTester::Reducer::Scope& scope, const std::vector<MEDTester::SatValue>& model);
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_REDUCER_H_
@@ -0,0 +1,104 @@
+#ifndef MEDTESTER_REORDER_BUFFER_H_
+#define MEDTESTER_REORDER_BUFFER_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+
+namespace MEDTester
+{
+
+/* Collects items produced out of order by several threads and hands them out strictly in the
+ * order of their indices (0, 1, 2, ...). The producer has to reserve an index before it starts
+ * working on it, which blocks while the index is more than 'window' items ahead of the consumer,
+ * so the number of buffered items stays bounded. */
+template <typename T> class ReorderBuffer
+{
+public:
+    // Constructor and deconstructor:
+    ReorderBuffer(size_t window);
+    ~ReorderBuffer();
+
+    // Producer side:
+    bool reserve(long index);
+    void put(long index, T item);
+    void finish(long total);
+
+    // Consumer side:
+    bool take(T& item);
+
+    // Stops all waiting threads (reserve and take return false afterwards):
+    void abort();
+
+private:
+    long mWindow;
+    long mNext;
+    long mTotal;        // -1 until the total number of items is known.
+    bool mAborted;
+    std::map<long, T> mItems;
+    std::mutex mMutex;
+    std::condition_variable mReady;
+    std::condition_variable mTaken;
+};
+
+
+template <typename T> ReorderBuffer<T>::ReorderBuffer(size_t window)
+{
+    mWindow = window > 0 ? (long) window : 1;
+    mNext = 0;
+    mTotal = -1;
+    mAborted = false;
+}
+
+template <typename T> ReorderBuffer<T>::~ReorderBuffer() {}
+
+template <typename T> bool ReorderBuffer<T>::reserve(long index)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mTaken.wait(lock, [this, index] { return mAborted || index < mNext + mWindow; });
+    return !mAborted;
+}
+
+template <typename T> void ReorderBuffer<T>::put(long index, T item)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mItems.emplace(index, std::move(item));
+    if (index == mNext) mReady.notify_all();
+}
+
+template <typename T> void ReorderBuffer<T>::finish(long total)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTotal = total;
+    mReady.notify_all();
+}
+
+template <typename T> bool ReorderBuffer<T>::take(T& item)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mReady.wait(lock, [this] {
+        return mAborted || (!mItems.empty() && mItems.begin()->first == mNext) || (mTotal != -1 && mNext >= mTotal);
+    });
+    if (mAborted || mItems.empty() || mItems.begin()->first != mNext) return false;
+
+    item = std::move(mItems.begin()->second);
+    mItems.erase(mItems.begin());
+    ++mNext;
+    mTaken.notify_all();
+    return true;
+}
+
+template <typename T> void ReorderBuffer<T>::abort()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mAborted = true;
+    mReady.notify_all();
+    mTaken.notify_all();
+}
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_REORDER_BUFFER_H_
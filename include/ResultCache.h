@@ -0,0 +1,64 @@
+#ifndef MEDTESTER_RESULT_CACHE_H_
+#define MEDTESTER_RESULT_CACHE_H_
+
+#include "typedefs.h"
+#include "CubicGraph.h"
+#include "CanonicalForm.h"
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace MEDTester
+{
+
+/* Results of already analysed graphs indexed by the canonical certificate, so an isomorphic copy of
+ * a graph is answered without solving it again. Decompositions are stored in the canonical
+ * labelling and translated to the labelling of the graph being looked up. The cache is shared by
+ * all analysing threads and stops accepting new results once it holds MAX_ENTRIES_COUNT of them. */
+class ResultCache
+{
+public:
+    // Cached answer for one graph (only the parts needed by the output mode are filled in):
+    struct Result
+    {
+        bool decomposable = false;
+        uint64_t decompositionsCount = 0;
+        MEDTester::Decomposition decomposition;
+    };
+
+    // Constructor and deconstructor:
+    ResultCache();
+    ~ResultCache();
+
+    // Cache operations:
+    bool find(const MEDTester::CubicGraph& graph, const MEDTester::CanonicalForm& form, Result& result);
+    void insert(const MEDTester::CubicGraph& graph, const MEDTester::CanonicalForm& form, const Result& result);
+
+private:
+    struct Entry
+    {
+        bool decomposable;
+        uint64_t decompositionsCount;
+        std::vector<MEDTester::EdgeType> decomposition;     // Type of the j-th edge of canonical vertex c at 3*c + j.
+    };
+
+    struct CertificateHash
+    {
+        size_t operator()(const std::vector<int>& certificate) const;
+    };
+
+    std::unordered_map<std::vector<int>, Entry, CertificateHash> mEntries;
+    std::mutex mMutex;
+
+    static const size_t MAX_ENTRIES_COUNT;
+
+    static int canonicalSlot(const MEDTester::CubicGraph& graph, const MEDTester::CanonicalForm& form, int vertex, int index);
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_RESULT_CACHE_H_
@@ -0,0 +1,85 @@
+#ifndef MEDTESTER_RESULT_READER_H_
+#define MEDTESTER_RESULT_READER_H_
+
+#include "typedefs.h"
+
+#include <string>
+#include <vector>
+#include <exception>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace MEDTester
+{
+
+/* Reader of the results written in the binary coloring mode. The file is memory-mapped and the
+ * records are decoded one by one. All numbers are 32-bit little-endian:
+ *   header: "MEDR", version (1 byte), flags (1 byte, ADJACENCY_FLAG), 2 reserved bytes
+ *   record: graph number, number of vertices n, decomposable (1 byte),
+ *           adjacency list (3n numbers, only with ADJACENCY_FLAG),
+ *           types of the 3n/2 edges packed by 3 bits from the lowest bit (only if decomposable)
+ * Edges are in the canonical order - edge uv (u < v) is at the position of v in the adjacency
+ * line of u, lines are taken from vertex 0. Edge types are the values of EdgeType. */
+class ResultReader
+{
+public:
+    // Exception thrown when the file is not a valid result file
+    class WrongFormatException : public std::exception
+    {
+        private:
+            std::string message = "Wrong Result File: ";
+
+        public:
+            WrongFormatException(const std::string& msg) throw() { message += msg; }
+            virtual ~WrongFormatException() throw() {}
+            const char* what() const throw() { return message.c_str(); }
+    };
+
+    // One decoded record:
+    struct Record
+    {
+        int graphNum;
+        int verticesCount;
+        bool decomposable;
+        MEDTester::FlatAdjList adjList;                 // Empty if the file has no adjacency lists.
+        std::vector<MEDTester::EdgeType> edgeTypes;     // In the canonical order, empty if not decomposable.
+    };
+
+    // Constructor and deconstructor:
+    ResultReader(const std::string& filename);
+    ~ResultReader();
+
+    ResultReader(const ResultReader&) = delete;
+    ResultReader& operator=(const ResultReader&) = delete;
+
+    // Getters:
+    bool isOpen() const;
+    bool hasAdjacency() const;
+
+    // Reading functions:
+    bool next(Record& record);                          // Returns false at the end of the file.
+
+    static MEDTester::Decomposition getDecomposition(const MEDTester::FlatAdjList& adjList, const std::vector<MEDTester::EdgeType>& edgeTypes);
+
+    // Format constants (shared with the writer):
+    static const char MAGIC[4];
+    static const uint8_t VERSION;
+    static const uint8_t ADJACENCY_FLAG;
+    static const size_t HEADER_SIZE;
+
+private:
+    int mFd;
+    const unsigned char* mData;
+    size_t mLength;
+    size_t mPos;
+    uint8_t mFlags;
+
+    void close();
+    uint32_t readUInt32();
+    void require(size_t count) const;
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_RESULT_READER_H_
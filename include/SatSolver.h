@@ -3,17 +3,44 @@
 
 #include "typedefs.h"
 #include "CubicGraph.h"
+#include "Encoding.h"
 
-#include <cryptominisat5/cryptominisat.h>
+#ifdef SAT
+    #include <cryptominisat5/cryptominisat.h>
+#else
+    #include "CdclSolver.h"
+#endif
 
 #include <vector>
+#include <initializer_list>
 #include <utility>
+#include <memory>
+#include <unordered_map>
+#include <atomic>
+#include <cstdint>
 
 
 namespace MEDTester
 {
 
-typedef std::vector<CMSat::Lit> Clause;
+/* Without the cryptominisat library, the built-in solver (with the same interface) is used. */
+#ifdef SAT
+    typedef CMSat::SATSolver SatBackend;
+    typedef CMSat::Lit SatLit;
+    typedef CMSat::lbool SatValue;
+    inline const SatValue SAT_TRUE = CMSat::l_True;
+    inline const SatValue SAT_UNDEF = CMSat::l_Undef;
+    inline const bool SAT_DEFAULT_POLARITY = false;
+#else
+    typedef MEDTester::CdclSolver SatBackend;
+    typedef MEDTester::CdclSolver::Lit SatLit;
+    typedef MEDTester::CdclSolver::LBool SatValue;
+    inline const SatValue SAT_TRUE = MEDTester::CdclSolver::LBool::L_TRUE;
+    inline const SatValue SAT_UNDEF = MEDTester::CdclSolver::LBool::L_UNDEF;
+    inline const bool SAT_DEFAULT_POLARITY = true;
+#endif
+
+typedef std::vector<MEDTester::SatLit> Clause;
 
 enum class SatEdgeType
 {
@@ -24,38 +51,117 @@ enum class SatEdgeType
     STAR_CENTER = 4
 };
 
+// Variables of one edge in the compact encoding (matching edge has none of them set):
+enum class CompactVar
+{
+    CYCLE = 0,
+    PARITY = 1,         // Parity of a cycle edge, false for other edges.
+    STAR_CENTER = 2,
+    STAR_LEAF = 3
+};
+
+/* Keeps one solver for each number of vertices, so consecutive graphs of the same order can be
+ * solved incrementally in the same solver instead of building a new one for every graph. A pool
+ * is not thread-safe, each thread should have its own. Solving in the pool's solvers stops once the
+ * interrupt flag (if any) is set. */
+class SatSolverPool
+{
+public:
+    SatSolverPool(MEDTester::Encoding encoding, std::atomic<bool>* interrupt = nullptr);
+    ~SatSolverPool();
+
+    MEDTester::SatBackend* acquire(int verticesCount);
+    MEDTester::Encoding getEncoding() const;
+    std::atomic<bool>* getInterrupt() const;
+
+private:
+    struct Instance
+    {
+        std::unique_ptr<MEDTester::SatBackend> solver;
+        unsigned int graphsCount = 0;
+    };
+
+    std::unordered_map<int, Instance> mInstances;
+    MEDTester::Encoding mEncoding;
+    std::atomic<bool>* mInterrupt;
+
+    static const unsigned int GRAPHS_PER_INSTANCE;
+};
+
 class SatSolver
 {
 public:
-    SatSolver(const MEDTester::CubicGraph& graph);
-    SatSolver(const MEDTester::CubicGraph& graph, unsigned int numThreads);
+    // Time spent by building the theory and by the solver, and statistics of the solver:
+    struct Stats
+    {
+        uint64_t theoryNanos = 0;
+        uint64_t solveNanos = 0;
+        uint64_t conflicts = 0;
+        uint64_t decisions = 0;
+        uint64_t propagations = 0;
+    };
+
+    SatSolver(const MEDTester::CubicGraph& graph, MEDTester::Encoding encoding);
+    SatSolver(const MEDTester::CubicGraph& graph, MEDTester::Encoding encoding, unsigned int numThreads, bool invertPolarity = false, std::atomic<bool>* interrupt = nullptr);
+    SatSolver(const MEDTester::CubicGraph& graph, MEDTester::SatSolverPool& pool);
     ~SatSolver();
 
+    SatSolver(const SatSolver&) = delete;
+    SatSolver& operator=(const SatSolver&) = delete;
+
     bool isDecomposable() const;
+    bool isInterrupted() const;         // The result is not valid then.
     MEDTester::Decomposition getDecomposition() const;
     int getDecompositionsCount();
+    const MEDTester::SatSolver::Stats& getStats() const;
 
 private:
+    friend class SatSolverPool;
+
     MEDTester::CubicGraph mGraph;
+    MEDTester::Encoding mEncoding;
+    int mVarsPerEdge;
 
     MEDTester::Decomposition mDecomposition;
     bool mDecomposable;
     int mDecompositionsCount;
     bool mCycleEquiv;
     bool mNoNextDecomposition;
+    bool mInterrupted;
+    std::atomic<bool>* mInterrupt;
 
-    MEDTester::Matrix mEdgeVarNums;
-    std::vector<std::pair<int,int>> mEdgeVars;
+    std::unique_ptr<MEDTester::SatBackend> mOwnSolver;
+    MEDTester::SatBackend* mSolver;          // Either mOwnSolver or a solver shared from a pool.
+    int mActivationVar;                 // -1 if the solver is not shared.
+    int mSymmetryVar;                   // Activates the symmetry breaking clauses (-1 if there are none).
+    MEDTester::Clause mClause;          // Clause being added, reused by all clauses of the graph.
+    MEDTester::SatSolver::Stats mStats;
 
-    CMSat::SATSolver mSolver;
+    void init(MEDTester::Encoding encoding);
 
-    void init();
-
-    int edgeVarToNum(int v1, int v2, MEDTester::SatEdgeType type) const;
-    std::pair<std::pair<int,int>, MEDTester::SatEdgeType> edgeVarFromNum(int var) const;
+    int edgeVarToNum(int vertex, int index, MEDTester::SatEdgeType type) const;
     MEDTester::EdgeType set2et(MEDTester::SatEdgeType type) const;
+    MEDTester::SatLit compactLit(int vertex, int index, MEDTester::CompactVar var, bool isInverted) const;
+    MEDTester::EdgeType getEdgeType(const std::vector<MEDTester::SatValue>& model, int edge) const;
+
+    static void createEdgeTypeTheory(MEDTester::SatBackend& solver, int edgesCount);
+    static void createCycleEquivTheory(MEDTester::SatBackend& solver, int edgesCount);
+    static void createCompactEdgeTheory(MEDTester::SatBackend& solver, int edgesCount);
 
+    void addClause(const MEDTester::Clause& clause);
+    void addClause(std::initializer_list<MEDTester::SatLit> lits);
+    MEDTester::SatValue solveWithActivation(bool breakSymmetries);
     void createTheory();
+    void createOneHotTheory();
+    void createCompactTheory();
+    void createSymmetryBreakingTheory();
+    void addLexLeader(const std::vector<int>& permutation);
+    void addFirstCycleEdgeParity();
+    void readDecomposition();
+
+    static const uint64_t SYMMETRY_BREAKING_CONFLICTS;
+    static const size_t MAX_SYMMETRIES_COUNT;
+    static const size_t MAX_LEX_LEADER_LENGTH;
     void solve();
     bool solveNext(bool overwrite);
 };
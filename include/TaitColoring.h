@@ -0,0 +1,56 @@
+#ifndef MEDTESTER_TAIT_COLORING_H_
+#define MEDTESTER_TAIT_COLORING_H_
+
+#include "CubicGraph.h"
+#include "typedefs.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace MEDTester
+{
+
+/* Search for a 3-edge-coloring (Tait coloring) of a cubic graph. One color class of such a coloring
+ * is a perfect matching and the other two classes form a union of even cycles (colors alternate on
+ * them), so every 3-edge-colorable graph has a decomposition consisting only of a matching and even
+ * cycles. Most of the cubic graphs are colorable and the search finds a coloring much faster than
+ * the general decomposition search, so it is used as a first stage of the analysis. */
+class TaitColoring
+{
+public:
+    // Constructor and deconstructor:
+    TaitColoring(const MEDTester::CubicGraph& graph);
+    ~TaitColoring();
+    void reset();                                   // Starts over after the graph was replaced (see CubicGraph::assign).
+
+    // Getters:
+    MEDTester::Decomposition getDecomposition();    // Color 0 is the matching, colors 1 and 2 the cycles.
+    void getDecomposition(MEDTester::Decomposition& decomposition);     // Fills the given (reused) decomposition.
+
+    // Functions for checking properties of the graph:
+    bool isColorable();
+
+private:
+    const MEDTester::CubicGraph& mGraph;
+    std::vector<int8_t> mColors;                    // Color of each edge, -1 if not colored yet.
+    std::vector<uint8_t> mUsedColors;               // Bitset of colors used on edges of each vertex.
+    std::vector<int> mOrder;                        // Order in which the edges are colored.
+    std::vector<int> mTrail;                        // Colored edges in the order of coloring.
+    std::vector<std::pair<int,int>> mPending;
+    std::vector<bool> mVisited;                     // Arrays of the BFS which orders the edges.
+    std::vector<bool> mOrdered;
+    std::vector<int> mQueue;
+    bool mSearchDone;
+    bool mColorable;
+
+    void search();
+    bool searchHelper(size_t index);
+    bool assignColor(int edgeId, int color);
+    void undo(size_t trailSize);
+};
+
+} // namespace MEDTester
+
+#endif // MEDTESTER_TAIT_COLORING_H_
@@ -20,6 +20,10 @@ typedef std::vector<int> MatrixLine;
 
 typedef std::vector<MatrixLine> Matrix;
 
+/* Adjacency list of a cubic graph stored in a single array - neighbours of vertex v are stored at
+ * positions 3*v, 3*v+1 and 3*v+2. */
+typedef std::vector<int> FlatAdjList;
+
 typedef std::vector<std::vector<EdgeType>> Decomposition;
 
 } // namespace MEDTester
@@ -0,0 +1,171 @@
+#include "CanonicalForm.h"
+
+#include "CubicGraph.h"
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstddef>
+
+
+const size_t MEDTester::CanonicalForm::MAX_LEAVES_COUNT = 1024;
+const size_t MEDTester::CanonicalForm::MAX_AUTOMORPHISMS_COUNT = 64;
+
+
+MEDTester::CanonicalForm::CanonicalForm(const MEDTester::CubicGraph& graph) : mGraph(graph)
+{
+    mLeavesCount = 0;
+    mComputed = true;
+    std::vector<int> sequence;
+    search(std::vector<int>(graph.getVerticesCount(), 0), sequence);
+    if (!mComputed) {
+        mCertificate.clear();
+        mLabels.clear();
+    }
+}
+
+MEDTester::CanonicalForm::~CanonicalForm() {}
+
+
+const std::vector<int>& MEDTester::CanonicalForm::getCertificate() const
+{
+    return mCertificate;
+}
+
+int MEDTester::CanonicalForm::getLabel(int vertex) const
+{
+    return mLabels[vertex];
+}
+
+/* Automorphisms stay valid even if the search was stopped, only the certificate is thrown away. */
+const std::vector<std::vector<int>>& MEDTester::CanonicalForm::getAutomorphisms() const
+{
+    return mAutomorphisms;
+}
+
+bool MEDTester::CanonicalForm::isComputed() const
+{
+    return mComputed;
+}
+
+
+/* Colour refinement - vertices with the same colour are split by the colours of their neighbours
+ * until the partition is stable. New colours are ranks of the (colour, neighbour colours) tuples,
+ * so they don't depend on the numbering of the vertices. */
+void MEDTester::CanonicalForm::refine(std::vector<int>& colors) const
+{
+    int verticesCount = mGraph.getVerticesCount();
+    std::vector<std::array<int, 4>> signatures(verticesCount);
+    std::vector<int> order(verticesCount);
+
+    std::vector<int> sorted(colors);
+    std::sort(sorted.begin(), sorted.end());
+    size_t colorsCount = std::unique(sorted.begin(), sorted.end()) - sorted.begin();
+
+    while (true) {
+        for (int v = 0; v < verticesCount; ++v) {
+            signatures[v] = {colors[v], colors[mGraph.getNeighbour(v, 0)], colors[mGraph.getNeighbour(v, 1)], colors[mGraph.getNeighbour(v, 2)]};
+            std::sort(signatures[v].begin() + 1, signatures[v].end());
+            order[v] = v;
+        }
+        std::sort(order.begin(), order.end(), [&signatures] (int a, int b) { return signatures[a] < signatures[b]; });
+
+        size_t newColorsCount = 0;
+        for (int k = 0; k < verticesCount; ++k) {
+            if (k > 0 && signatures[order[k]] != signatures[order[k-1]]) ++newColorsCount;
+            colors[order[k]] = newColorsCount;
+        }
+        ++newColorsCount;
+
+        if (verticesCount == 0 || newColorsCount == colorsCount) return;
+        colorsCount = newColorsCount;
+    }
+}
+
+/* Vertices individualised on the way from the root are in the sequence. A leaf with the same
+ * certificate as the best one gives an automorphism of the graph. Automorphisms fixing the sequence
+ * map a subtree to an equivalent one, so only one vertex of each of their orbits in the target
+ * class is individualised. */
+void MEDTester::CanonicalForm::search(const std::vector<int>& initialColors, std::vector<int>& sequence)
+{
+    if (!mComputed) return;
+
+    int verticesCount = mGraph.getVerticesCount();
+    std::vector<int> colors(initialColors);
+    refine(colors);
+
+    std::vector<int> cellSizes(verticesCount, 0);
+    for (int c : colors) ++cellSizes[c];
+
+    int target = -1;
+    for (int c = 0; c < verticesCount; ++c) {
+        if (cellSizes[c] > 1 && (target == -1 || cellSizes[c] < cellSizes[target])) target = c;
+    }
+
+    /* Discrete partition gives a labelling, its certificate is compared with the best one. */
+    if (target == -1) {
+        if (++mLeavesCount > MAX_LEAVES_COUNT) {
+            mComputed = false;
+            return;
+        }
+
+        std::vector<int> certificate(3 * (size_t) verticesCount);
+        for (int v = 0; v < verticesCount; ++v) {
+            int* line = certificate.data() + 3*colors[v];
+            for (int i = 0; i < 3; ++i) line[i] = colors[mGraph.getNeighbour(v, i)];
+            std::sort(line, line + 3);
+        }
+        if (mLabels.empty() || certificate < mCertificate) {
+            mCertificate.swap(certificate);
+            mLabels = colors;
+        }
+        else if (certificate == mCertificate && mAutomorphisms.size() < MAX_AUTOMORPHISMS_COUNT) {
+            std::vector<int> inverse(verticesCount);
+            for (int v = 0; v < verticesCount; ++v) inverse[mLabels[v]] = v;
+            std::vector<int> automorphism(verticesCount);
+            for (int v = 0; v < verticesCount; ++v) automorphism[v] = inverse[colors[v]];
+            mAutomorphisms.push_back(std::move(automorphism));
+        }
+        return;
+    }
+
+    std::vector<int> individualized(verticesCount);
+    std::vector<int> explored;
+    for (int v = 0; v < verticesCount; ++v) {
+        if (colors[v] != target || isEquivalent(v, explored, sequence)) continue;
+        explored.push_back(v);
+
+        for (int w = 0; w < verticesCount; ++w) {
+            individualized[w] = 2*colors[w] + (w == v ? 0 : 1);
+        }
+        sequence.push_back(v);
+        search(individualized, sequence);
+        sequence.pop_back();
+    }
+}
+
+/* Checks whether some of the found automorphisms fixing the sequence maps the vertex to an already
+ * explored one (the orbits are computed by a union-find over the generators). */
+bool MEDTester::CanonicalForm::isEquivalent(int vertex, const std::vector<int>& explored, const std::vector<int>& sequence) const
+{
+    if (explored.empty() || mAutomorphisms.empty()) return false;
+
+    std::vector<int> parents(mGraph.getVerticesCount());
+    for (size_t v = 0; v < parents.size(); ++v) parents[v] = v;
+    auto find = [&parents] (int v) {
+        while (parents[v] != v) v = parents[v] = parents[parents[v]];
+        return v;
+    };
+
+    for (const std::vector<int>& automorphism : mAutomorphisms) {
+        bool fixesSequence = true;
+        for (int v : sequence) fixesSequence = fixesSequence && automorphism[v] == v;
+        if (!fixesSequence) continue;
+        for (size_t v = 0; v < parents.size(); ++v) parents[find(v)] = find(automorphism[v]);
+    }
+
+    for (int v : explored) {
+        if (find(v) == find(vertex)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,598 @@
+#include "CdclSolver.h"
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+
+#define HEADER_SIZE 2
+#define LEARNT_FLAG 1u
+#define DELETED_FLAG 2u
+#define LBD_SHIFT 2
+
+#define VAR_DECAY 0.95
+#define RESTART_BASE 100
+#define MIN_MAX_LEARNTS 2000
+#define MAX_LEARNTS_GROWTH 1.1
+#define WATCHES_RESERVED 8
+
+
+const uint32_t MEDTester::CdclSolver::NO_CLAUSE = UINT32_MAX;
+
+
+MEDTester::CdclSolver::CdclSolver(void* config, std::atomic<bool>* interrupt)
+{
+    mOk = true;
+    mQueueHead = 0;
+    mMaxLearnts = MIN_MAX_LEARNTS;
+    mSimplifiedTrailSize = 0;
+    mVarInc = 1.0;
+    mConflicts = 0;
+    mDecisions = 0;
+    mPropagations = 0;
+    mMaxConflicts = UINT64_MAX;
+    mDefaultPolarity = true;
+    mInterrupt = interrupt;
+}
+
+MEDTester::CdclSolver::~CdclSolver() {}
+
+
+void MEDTester::CdclSolver::new_var()
+{
+    int var = mAssigns.size();
+    mAssigns.push_back(LBool::L_UNDEF);
+    mLevels.push_back(0);
+    mReasons.push_back(NO_CLAUSE);
+    mPhases.push_back(!mDefaultPolarity);
+    mSeen.push_back(0);
+    mActivity.push_back(0.0);
+    mHeapIndex.push_back(-1);
+    for (int sign = 0; sign < 2; ++sign) {
+        mWatches.emplace_back();
+        mWatches.back().reserve(WATCHES_RESERVED);
+    }
+    heapInsert(var);
+}
+
+void MEDTester::CdclSolver::new_vars(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) new_var();
+}
+
+uint32_t MEDTester::CdclSolver::nVars() const
+{
+    return mAssigns.size();
+}
+
+/* Clauses can be added only between calls of solve (the solver is always at the top level then).
+ * Literals already false at the top level are left out and satisfied clauses are not stored at all. */
+bool MEDTester::CdclSolver::add_clause(const std::vector<Lit>& lits)
+{
+    if (!mOk) return false;
+
+    std::vector<Lit>& clause = mAddedClause;
+    clause.assign(lits.begin(), lits.end());
+    std::sort(clause.begin(), clause.end());
+
+    size_t j = 0;
+    for (size_t i = 0; i < clause.size(); ++i) {
+        if (value(clause[i]) == LBool::L_TRUE || (i > 0 && clause[i] == ~clause[i-1])) return true;
+        if (value(clause[i]) == LBool::L_FALSE || (j > 0 && clause[i] == clause[j-1])) continue;
+        clause[j++] = clause[i];
+    }
+    clause.resize(j);
+
+    if (clause.empty()) {
+        mOk = false;
+    } else if (clause.size() == 1) {
+        enqueue(clause[0], NO_CLAUSE);
+        mOk = propagate() == NO_CLAUSE;
+    } else {
+        attachClause(allocClause(clause, false, 0));
+    }
+
+    return mOk;
+}
+
+MEDTester::CdclSolver::LBool MEDTester::CdclSolver::solve(const std::vector<Lit>* assumptions)
+{
+    static const std::vector<Lit> NO_ASSUMPTIONS;
+
+    mModel.clear();
+    if (!mOk) return LBool::L_FALSE;
+
+    if (mLearnts.size() >= mMaxLearnts) reduceLearnts();
+    else if (mTrail.size() > mSimplifiedTrailSize) simplify();
+
+    LBool status = LBool::L_UNDEF;
+    for (int restarts = 0; status == LBool::L_UNDEF && mConflicts < mMaxConflicts && !isInterrupted(); ++restarts) {
+        long conflictsLimit = (long) std::min<double>(luby(2, restarts) * RESTART_BASE, mMaxConflicts - mConflicts);
+        status = search(conflictsLimit, assumptions ? *assumptions : NO_ASSUMPTIONS);
+        if (status != LBool::L_UNDEF) break;
+
+        if (mLearnts.size() >= mMaxLearnts) reduceLearnts();
+        else if (mTrail.size() > mSimplifiedTrailSize) simplify();
+    }
+
+    if (status == LBool::L_TRUE) mModel = mAssigns;
+    cancelUntil(0);
+    return status;
+}
+
+const std::vector<MEDTester::CdclSolver::LBool>& MEDTester::CdclSolver::get_model() const
+{
+    return mModel;
+}
+
+void MEDTester::CdclSolver::set_num_threads(unsigned int numThreads) {}
+
+/* As in cryptominisat, the limit counts from the conflicts made so far. */
+void MEDTester::CdclSolver::set_max_confl(uint64_t maxConflicts)
+{
+    mMaxConflicts = maxConflicts > UINT64_MAX - mConflicts ? UINT64_MAX : mConflicts + maxConflicts;
+}
+
+/* Phases are saved as the sign of the literal, so the polarity is stored negated. */
+void MEDTester::CdclSolver::set_default_polarity(bool polarity)
+{
+    mDefaultPolarity = polarity;
+    std::fill(mPhases.begin(), mPhases.end(), !polarity);
+}
+
+uint64_t MEDTester::CdclSolver::get_sum_conflicts() const
+{
+    return mConflicts;
+}
+
+uint64_t MEDTester::CdclSolver::get_sum_decisions() const
+{
+    return mDecisions;
+}
+
+uint64_t MEDTester::CdclSolver::get_sum_propagations() const
+{
+    return mPropagations;
+}
+
+
+MEDTester::CdclSolver::LBool MEDTester::CdclSolver::value(Lit lit) const
+{
+    LBool assign = mAssigns[lit.var()];
+    if (assign == LBool::L_UNDEF) return LBool::L_UNDEF;
+    return (LBool) ((uint8_t) assign ^ (uint8_t) lit.sign());
+}
+
+/* Checked once per conflict or decision. The flag guards no other data, so a relaxed load is enough. */
+bool MEDTester::CdclSolver::isInterrupted() const
+{
+    return mInterrupt && mInterrupt->load(std::memory_order_relaxed);
+}
+
+int MEDTester::CdclSolver::decisionLevel() const
+{
+    return mTrailLimits.size();
+}
+
+void MEDTester::CdclSolver::newDecisionLevel()
+{
+    mTrailLimits.push_back(mTrail.size());
+}
+
+void MEDTester::CdclSolver::enqueue(Lit lit, uint32_t reason)
+{
+    mAssigns[lit.var()] = lit.sign() ? LBool::L_FALSE : LBool::L_TRUE;
+    mLevels[lit.var()] = decisionLevel();
+    mReasons[lit.var()] = reason;
+    mTrail.push_back(lit);
+}
+
+/* Unassigns everything above the given level. Values of the unassigned variables are saved and used
+ * as their polarity in the next decisions. */
+void MEDTester::CdclSolver::cancelUntil(int level)
+{
+    if (decisionLevel() <= level) return;
+
+    for (size_t i = mTrail.size(); i-- > (size_t) mTrailLimits[level];) {
+        int var = mTrail[i].var();
+        mAssigns[var] = LBool::L_UNDEF;
+        mReasons[var] = NO_CLAUSE;
+        mPhases[var] = mTrail[i].sign();
+        heapInsert(var);
+    }
+    mQueueHead = mTrailLimits[level];
+    mTrail.resize(mTrailLimits[level]);
+    mTrailLimits.resize(level);
+}
+
+
+uint32_t MEDTester::CdclSolver::allocClause(const std::vector<Lit>& lits, bool learnt, uint32_t lbd)
+{
+    uint32_t clause = mArena.size();
+    mArena.push_back(lits.size());
+    mArena.push_back((learnt ? LEARNT_FLAG : 0) | (lbd << LBD_SHIFT));
+    for (Lit lit : lits) mArena.push_back(lit.toInt());
+    return clause;
+}
+
+void MEDTester::CdclSolver::attachClause(uint32_t clause)
+{
+    uint32_t* lits = clauseLits(clause);
+    mWatches[lits[0]].push_back({clause, Lit::fromInt(lits[1])});
+    mWatches[lits[1]].push_back({clause, Lit::fromInt(lits[0])});
+}
+
+uint32_t MEDTester::CdclSolver::clauseSize(uint32_t clause) const
+{
+    return mArena[clause];
+}
+
+uint32_t* MEDTester::CdclSolver::clauseLits(uint32_t clause)
+{
+    return mArena.data() + clause + HEADER_SIZE;
+}
+
+
+/* Propagates all enqueued literals, returns the conflicting clause or NO_CLAUSE. The first two
+ * literals of each clause are watched; when a watched literal becomes false, another non-false
+ * literal is looked for and if there is none, the clause is unit (or conflicting). A clause is
+ * skipped right away when its blocker (some other literal of it) is true. */
+uint32_t MEDTester::CdclSolver::propagate()
+{
+    uint32_t conflict = NO_CLAUSE;
+
+    while (mQueueHead < mTrail.size()) {
+        Lit falseLit = ~mTrail[mQueueHead++];
+        ++mPropagations;
+        std::vector<Watcher>& watchers = mWatches[falseLit.toInt()];
+
+        size_t i = 0, j = 0;
+        while (i < watchers.size()) {
+            Watcher watcher = watchers[i];
+            if (value(watcher.blocker) == LBool::L_TRUE) {
+                watchers[j++] = watchers[i++];
+                continue;
+            }
+
+            uint32_t* lits = clauseLits(watcher.clause);
+            if (lits[0] == falseLit.toInt()) std::swap(lits[0], lits[1]);
+            ++i;
+
+            Lit first = Lit::fromInt(lits[0]);
+            Watcher updated = {watcher.clause, first};
+            if (first != watcher.blocker && value(first) == LBool::L_TRUE) {
+                watchers[j++] = updated;
+                continue;
+            }
+
+            uint32_t size = clauseSize(watcher.clause);
+            bool moved = false;
+            for (uint32_t k = 2; k < size; ++k) {
+                if (value(Lit::fromInt(lits[k])) != LBool::L_FALSE) {
+                    lits[1] = lits[k];
+                    lits[k] = falseLit.toInt();
+                    mWatches[lits[1]].push_back(updated);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            watchers[j++] = updated;
+            if (value(first) == LBool::L_FALSE) {
+                conflict = watcher.clause;
+                mQueueHead = mTrail.size();
+                while (i < watchers.size()) watchers[j++] = watchers[i++];
+            } else {
+                enqueue(first, watcher.clause);
+            }
+        }
+        watchers.resize(j);
+    }
+
+    return conflict;
+}
+
+/* First UIP conflict analysis. The learnt clause contains the negation of the UIP as its first
+ * literal and a literal from the backjump level as its second literal (those two are watched after
+ * the backjump). Literals implied by other literals of the clause are removed. */
+void MEDTester::CdclSolver::analyze(uint32_t conflict, std::vector<Lit>& learnt, int& backtrackLevel, uint32_t& lbd)
+{
+    learnt.clear();
+    learnt.push_back(Lit());
+
+    int pathCount = 0;
+    Lit p;
+    size_t index = mTrail.size();
+
+    do {
+        uint32_t* lits = clauseLits(conflict);
+        uint32_t size = clauseSize(conflict);
+        for (uint32_t k = (p == Lit() ? 0 : 1); k < size; ++k) {
+            Lit q = Lit::fromInt(lits[k]);
+            int var = q.var();
+            if (mSeen[var] || mLevels[var] == 0) continue;
+
+            bumpVar(var);
+            mSeen[var] = 1;
+            if (mLevels[var] >= decisionLevel()) ++pathCount;
+            else learnt.push_back(q);
+        }
+
+        while (!mSeen[mTrail[--index].var()]);
+        p = mTrail[index];
+        conflict = mReasons[p.var()];
+        mSeen[p.var()] = 0;
+        --pathCount;
+    } while (pathCount > 0);
+    learnt[0] = ~p;
+
+    std::vector<Lit> analyzed(learnt);
+    size_t j = 1;
+    for (size_t i = 1; i < learnt.size(); ++i) {
+        if (!isRedundant(learnt[i])) learnt[j++] = learnt[i];
+    }
+    learnt.resize(j);
+    for (Lit lit : analyzed) mSeen[lit.var()] = 0;
+
+    backtrackLevel = 0;
+    if (learnt.size() > 1) {
+        size_t maxIndex = 1;
+        for (size_t i = 2; i < learnt.size(); ++i) {
+            if (mLevels[learnt[i].var()] > mLevels[learnt[maxIndex].var()]) maxIndex = i;
+        }
+        std::swap(learnt[1], learnt[maxIndex]);
+        backtrackLevel = mLevels[learnt[1].var()];
+    }
+
+    std::vector<int> levels;
+    for (Lit lit : learnt) levels.push_back(mLevels[lit.var()]);
+    std::sort(levels.begin(), levels.end());
+    lbd = std::unique(levels.begin(), levels.end()) - levels.begin();
+}
+
+bool MEDTester::CdclSolver::isRedundant(Lit lit)
+{
+    uint32_t reason = mReasons[lit.var()];
+    if (reason == NO_CLAUSE) return false;
+
+    uint32_t* lits = clauseLits(reason);
+    for (uint32_t k = 1; k < clauseSize(reason); ++k) {
+        int var = Lit::fromInt(lits[k]).var();
+        if (!mSeen[var] && mLevels[var] > 0) return false;
+    }
+    return true;
+}
+
+/* Assumptions are decided first, one per decision level. The search ends with L_UNDEF (after
+ * returning to the top level) once the number of conflicts reaches the limit or the solver is
+ * interrupted. */
+MEDTester::CdclSolver::LBool MEDTester::CdclSolver::search(long conflictsLimit, const std::vector<Lit>& assumptions)
+{
+    long conflicts = 0;
+    std::vector<Lit> learnt;
+
+    while (true) {
+        uint32_t conflict = propagate();
+
+        if (conflict != NO_CLAUSE) {
+            ++conflicts;
+            ++mConflicts;
+            if (decisionLevel() == 0) {
+                mOk = false;
+                return LBool::L_FALSE;
+            }
+
+            int backtrackLevel;
+            uint32_t lbd;
+            analyze(conflict, learnt, backtrackLevel, lbd);
+            cancelUntil(backtrackLevel);
+
+            if (learnt.size() == 1) {
+                enqueue(learnt[0], NO_CLAUSE);
+            } else {
+                uint32_t clause = allocClause(learnt, true, lbd);
+                mLearnts.push_back(clause);
+                attachClause(clause);
+                enqueue(learnt[0], clause);
+            }
+            mVarInc /= VAR_DECAY;
+            continue;
+        }
+
+        if (conflicts >= conflictsLimit || isInterrupted()) {
+            cancelUntil(0);
+            return LBool::L_UNDEF;
+        }
+
+        Lit next;
+        while (decisionLevel() < (int) assumptions.size()) {
+            Lit assumption = assumptions[decisionLevel()];
+            if (value(assumption) == LBool::L_TRUE) {
+                newDecisionLevel();
+            } else if (value(assumption) == LBool::L_FALSE) {
+                cancelUntil(0);
+                return LBool::L_FALSE;
+            } else {
+                next = assumption;
+                break;
+            }
+        }
+
+        if (next == Lit()) {
+            next = pickBranchLit();
+            if (next == Lit()) return LBool::L_TRUE;
+        }
+
+        ++mDecisions;
+        newDecisionLevel();
+        enqueue(next, NO_CLAUSE);
+    }
+}
+
+MEDTester::CdclSolver::Lit MEDTester::CdclSolver::pickBranchLit()
+{
+    while (!mHeap.empty()) {
+        int var = heapPop();
+        if (mAssigns[var] == LBool::L_UNDEF) return Lit(var, mPhases[var]);
+    }
+    return Lit();
+}
+
+
+/* Removes clauses satisfied at the top level. Must be called at the top level. */
+void MEDTester::CdclSolver::simplify()
+{
+    for (uint32_t clause = 0; clause < mArena.size(); clause += HEADER_SIZE + clauseSize(clause)) {
+        if (mArena[clause + 1] & DELETED_FLAG) continue;
+
+        uint32_t* lits = clauseLits(clause);
+        for (uint32_t k = 0; k < clauseSize(clause); ++k) {
+            if (value(Lit::fromInt(lits[k])) == LBool::L_TRUE) {
+                mArena[clause + 1] |= DELETED_FLAG;
+                break;
+            }
+        }
+    }
+
+    mSimplifiedTrailSize = mTrail.size();
+    collectGarbage();
+}
+
+/* Removes half of the learnt clauses, the ones with the highest LBD (number of distinct decision
+ * levels in the clause when it was learnt) first. Clauses with LBD at most 2 are always kept. Must be
+ * called at the top level. */
+void MEDTester::CdclSolver::reduceLearnts()
+{
+    std::vector<uint32_t> learnts(mLearnts);
+    std::sort(learnts.begin(), learnts.end(), [this] (uint32_t a, uint32_t b) {
+        uint32_t lbdA = mArena[a + 1] >> LBD_SHIFT;
+        uint32_t lbdB = mArena[b + 1] >> LBD_SHIFT;
+        if (lbdA != lbdB) return lbdA > lbdB;
+        return clauseSize(a) > clauseSize(b);
+    });
+
+    for (size_t i = 0; i < learnts.size() / 2; ++i) {
+        if ((mArena[learnts[i] + 1] >> LBD_SHIFT) <= 2) break;
+        mArena[learnts[i] + 1] |= DELETED_FLAG;
+    }
+
+    mMaxLearnts = std::max((size_t) MIN_MAX_LEARNTS, (size_t) (mMaxLearnts * MAX_LEARNTS_GROWTH));
+    simplify();
+}
+
+/* Compacts the clause array and rebuilds the watch lists. At the top level no clause is a reason
+ * of a literal that matters for the analysis, so the reasons can be simply forgotten. The remaining
+ * clauses have no true literal and their false literals are dropped, which keeps the first two
+ * (watched) literals in place. */
+void MEDTester::CdclSolver::collectGarbage()
+{
+    std::vector<uint32_t> arena;
+    arena.reserve(mArena.size());
+    mLearnts.clear();
+    for (std::vector<Watcher>& watchers : mWatches) watchers.clear();
+    for (Lit lit : mTrail) mReasons[lit.var()] = NO_CLAUSE;
+
+    for (uint32_t clause = 0; clause < mArena.size(); clause += HEADER_SIZE + clauseSize(clause)) {
+        if (mArena[clause + 1] & DELETED_FLAG) continue;
+
+        uint32_t newClause = arena.size();
+        arena.push_back(0);
+        arena.push_back(mArena[clause + 1]);
+        uint32_t* lits = clauseLits(clause);
+        for (uint32_t k = 0; k < clauseSize(clause); ++k) {
+            if (value(Lit::fromInt(lits[k])) != LBool::L_FALSE) arena.push_back(lits[k]);
+        }
+        arena[newClause] = arena.size() - newClause - HEADER_SIZE;
+
+        if (mArena[clause + 1] & LEARNT_FLAG) mLearnts.push_back(newClause);
+    }
+
+    mArena.swap(arena);
+    for (uint32_t clause = 0; clause < mArena.size(); clause += HEADER_SIZE + clauseSize(clause)) {
+        attachClause(clause);
+    }
+}
+
+
+void MEDTester::CdclSolver::bumpVar(int var)
+{
+    mActivity[var] += mVarInc;
+    if (mActivity[var] > 1e100) {
+        for (double& activity : mActivity) activity *= 1e-100;
+        mVarInc *= 1e-100;
+    }
+    if (mHeapIndex[var] != -1) heapUp(mHeapIndex[var]);
+}
+
+void MEDTester::CdclSolver::heapInsert(int var)
+{
+    if (mHeapIndex[var] != -1) return;
+    mHeapIndex[var] = mHeap.size();
+    mHeap.push_back(var);
+    heapUp(mHeapIndex[var]);
+}
+
+void MEDTester::CdclSolver::heapUp(int pos)
+{
+    int var = mHeap[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (mActivity[mHeap[parent]] >= mActivity[var]) break;
+        mHeap[pos] = mHeap[parent];
+        mHeapIndex[mHeap[pos]] = pos;
+        pos = parent;
+    }
+    mHeap[pos] = var;
+    mHeapIndex[var] = pos;
+}
+
+void MEDTester::CdclSolver::heapDown(int pos)
+{
+    int var = mHeap[pos];
+    int size = mHeap.size();
+    while (2*pos + 1 < size) {
+        int child = 2*pos + 1;
+        if (child + 1 < size && mActivity[mHeap[child + 1]] > mActivity[mHeap[child]]) ++child;
+        if (mActivity[mHeap[child]] <= mActivity[var]) break;
+        mHeap[pos] = mHeap[child];
+        mHeapIndex[mHeap[pos]] = pos;
+        pos = child;
+    }
+    mHeap[pos] = var;
+    mHeapIndex[var] = pos;
+}
+
+int MEDTester::CdclSolver::heapPop()
+{
+    int var = mHeap[0];
+    mHeapIndex[var] = -1;
+    mHeap[0] = mHeap.back();
+    mHeap.pop_back();
+    if (!mHeap.empty()) {
+        mHeapIndex[mHeap[0]] = 0;
+        heapDown(0);
+    }
+    return var;
+}
+
+
+/* Finite subsequences of the Luby sequence (1, 1, 2, 1, 1, 2, 4, ...) multiplied by powers of y. */
+double MEDTester::CdclSolver::luby(double y, int x)
+{
+    int size = 1, seq = 0;
+    while (size < x + 1) {
+        ++seq;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        --seq;
+        x = x % size;
+    }
+
+    double result = 1;
+    for (int i = 0; i < seq; ++i) result *= y;
+    return result;
+}
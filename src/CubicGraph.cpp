@@ -3,11 +3,10 @@
 #include "typedefs.h"
 
 #include <algorithm>
-#include <queue>
 #include <cstring>
 #include <vector>
-#include <unordered_set>
 #include <iostream>
+#include <atomic>
 
 
 const std::vector<std::vector<MEDTester::EdgeType>> VERTEX_COLORINGS = {
@@ -17,30 +16,56 @@ const std::vector<std::vector<MEDTester::EdgeType>> VERTEX_COLORINGS = {
 };
 
 
-MEDTester::CubicGraph::CubicGraph(const MEDTester::Matrix& adjList)
+MEDTester::CubicGraph::CubicGraph(const MEDTester::Matrix& adjList) : CubicGraph(toFlatAdjList(adjList)) {}
+
+MEDTester::CubicGraph::CubicGraph(const MEDTester::FlatAdjList& adjList)
+{
+    assign(adjList);
+}
+
+MEDTester::CubicGraph::~CubicGraph() {}
+
+
+/* Besides the adjacency list, two more arrays of the same size are built (both linear in the number
+ * of vertices). For the i-th neighbour v of vertex u, the reverse index is the position of u in the
+ * adjacency list of v, and the edge id is a number of the edge uv from 0 to m-1. Edges are numbered in
+ * the order in which they first appear in the adjacency list. The arrays keep their capacity, so
+ * a graph reused for a sequence of graphs of the same size doesn't allocate any memory. */
+void MEDTester::CubicGraph::assign(const MEDTester::FlatAdjList& adjList)
 {
-    mVerticesCount = adjList.size();
+    mVerticesCount = adjList.size() / 3;
     mEdgesCount = (3 * mVerticesCount) / 2;
-    mAdjList = MEDTester::Matrix(mVerticesCount, MEDTester::MatrixLine(3));
-    mAdjListIndices = MEDTester::Matrix(mVerticesCount, MEDTester::MatrixLine(mVerticesCount, -1));
+    mAdjList.assign(adjList.begin(), adjList.end());
+    mReverseIndices.assign(3 * mVerticesCount, 0);
+    mEdgeIds.assign(3 * mVerticesCount, -1);
+    mEdgeSlots.clear();
+    mEdgeSlots.reserve(mEdgesCount);
 
     for (int u = 0; u < mVerticesCount; ++u) {
         for (int i = 0; i < 3; ++i) {
-            int v = adjList[u][i];
-            mAdjList[u][i] = v;
-            mAdjListIndices[u][v] = i;
+            int v = mAdjList[3*u + i];
+            int j = 0;
+            while (j < 3 && mAdjList[3*v + j] != u) ++j;
+            mReverseIndices[3*u + i] = (uint8_t) j;
+
+            if (mEdgeIds[3*v + j] != -1) {
+                mEdgeIds[3*u + i] = mEdgeIds[3*v + j];
+            } else {
+                mEdgeIds[3*u + i] = mEdgeSlots.size();
+                mEdgeSlots.push_back(3*u + i);
+            }
         }
     }
 
-    mDecomposition = MEDTester::Decomposition();
+    mDecomposition.clear();
     mDecompositionDone = false;
     mDecompositionsCount = -1;
     mBridgesCount = -1;
     mAllBridgesFound = false;
+    mInterrupt = nullptr;
+    mInterrupted = false;
 }
 
-MEDTester::CubicGraph::~CubicGraph() {}
-
 
 int MEDTester::CubicGraph::getVerticesCount() const
 {
@@ -52,14 +77,44 @@ int MEDTester::CubicGraph::getEdgesCount() const
     return mEdgesCount;
 }
 
-MEDTester::Matrix MEDTester::CubicGraph::getAdjList() const
+const MEDTester::FlatAdjList& MEDTester::CubicGraph::getAdjList() const
 {
     return mAdjList;
 }
 
-MEDTester::Matrix MEDTester::CubicGraph::getAdjListIndices() const
+int MEDTester::CubicGraph::getNeighbour(int vertex, int index) const
+{
+    return mAdjList[3*vertex + index];
+}
+
+int MEDTester::CubicGraph::getReverseIndex(int vertex, int index) const
+{
+    return mReverseIndices[3*vertex + index];
+}
+
+int MEDTester::CubicGraph::getIndex(int vertex, int neighbour) const
+{
+    for (int i = 0; i < 3; ++i) {
+        if (mAdjList[3*vertex + i] == neighbour) return i;
+    }
+    return -1;
+}
+
+int MEDTester::CubicGraph::getEdgeId(int vertex, int index) const
+{
+    return mEdgeIds[3*vertex + index];
+}
+
+std::pair<int,int> MEDTester::CubicGraph::getEdge(int edgeId) const
 {
-    return mAdjListIndices;
+    int slot = mEdgeSlots[edgeId];
+    return {slot / 3, mAdjList[slot]};
+}
+
+std::pair<int,int> MEDTester::CubicGraph::getEdgeSlot(int edgeId) const
+{
+    int slot = mEdgeSlots[edgeId];
+    return {slot / 3, slot % 3};
 }
 
 MEDTester::Decomposition MEDTester::CubicGraph::getDecomposition()
@@ -76,7 +131,7 @@ int MEDTester::CubicGraph::getDecompositionsCount()
 
 int MEDTester::CubicGraph::getBridgesCount()
 {
-    if (mAllBridgesFound) countBridges(false);
+    if (!mAllBridgesFound) countBridges(false);
     return mBridgesCount;
 }
 
@@ -90,7 +145,7 @@ bool MEDTester::CubicGraph::printGraph(std::ostream& out) const
     for (int i = 0; i < mVerticesCount; i++) {
         out << i << ":";
         for (int j = 0; j < 3; j++) {
-            out << " " << mAdjList[i][j];
+            out << " " << mAdjList[3*i + j];
         }
         out << "\n";
     }
@@ -98,52 +153,60 @@ bool MEDTester::CubicGraph::printGraph(std::ostream& out) const
 }
 
 
+/* Vertices are marked when they are queued, so the returned vector itself serves as the queue. */
 std::vector<int> MEDTester::CubicGraph::bfs(int vertex) const
 {
     std::vector<int> returnVector;
-    std::unordered_set<int> visited;
-    std::queue<int> queue;
+    if (vertex < 0) return returnVector;
 
-    queue.push(vertex);
-
-    while (!queue.empty()) {
-        if (queue.front() < 0 || visited.find(queue.front()) != visited.end()) {
-            queue.pop();
-            continue;
-        }
-
-        returnVector.push_back(queue.front());
+    TraversalWorkspace& workspace = getWorkspace();
+    workspace.reset(mVerticesCount);
+    returnVector.reserve(mVerticesCount);
+    returnVector.push_back(vertex);
+    workspace.visit(vertex);
 
+    for (size_t head = 0; head < returnVector.size(); ++head) {
+        int u = returnVector[head];
         for (int i = 0; i < 3; i++) {
-            queue.push(mAdjList[queue.front()][i]);
+            int v = mAdjList[3*u + i];
+            if (v >= 0 && workspace.visit(v)) returnVector.push_back(v);
         }
-
-        visited.insert(queue.front());
-        queue.pop();
     }
 
     return returnVector;
 }
 
+/* Vertices are returned in preorder - the same order as a recursive search which tries neighbours
+ * in the order of the adjacency list. The stack keeps the path to the current vertex and each vertex
+ * on it remembers which neighbour comes next, so large graphs don't run out of call stack. */
 std::vector<int> MEDTester::CubicGraph::dfs(int vertex) const
 {
     std::vector<int> returnVector;
-    std::unordered_set<int> visited;
-    dfsHelper(vertex, returnVector, visited);
-
-    return returnVector;
-}
-
-void MEDTester::CubicGraph::dfsHelper(int vertex, std::vector<int>& vec, std::unordered_set<int>& visited) const
-{
-    if (vertex < 0 || visited.find(vertex) != visited.end()) return;
-
-    vec.push_back(vertex);
-    visited.insert(vertex);
+    if (vertex < 0) return returnVector;
+
+    TraversalWorkspace& workspace = getWorkspace();
+    workspace.reset(mVerticesCount);
+    returnVector.reserve(mVerticesCount);
+    returnVector.push_back(vertex);
+    workspace.visit(vertex);
+    workspace.nextIndices[vertex] = 0;
+    workspace.stack.push_back(vertex);
+
+    while (!workspace.stack.empty()) {
+        int u = workspace.stack.back();
+        if (workspace.nextIndices[u] == 3) {
+            workspace.stack.pop_back();
+            continue;
+        }
 
-    for (int i = 0; i < 3; i++) {
-        dfsHelper(mAdjList[vertex][i], vec, visited);
+        int v = mAdjList[3*u + workspace.nextIndices[u]++];
+        if (v < 0 || !workspace.visit(v)) continue;
+        returnVector.push_back(v);
+        workspace.nextIndices[v] = 0;
+        workspace.stack.push_back(v);
     }
+
+    return returnVector;
 }
 
 
@@ -153,22 +216,146 @@ bool MEDTester::CubicGraph::isDecomposable() {
     return mDecomposition[0][0] != MEDTester::EdgeType::NONE;
 }
 
+void MEDTester::CubicGraph::setInterrupt(const std::atomic<bool>* interrupt)
+{
+    mInterrupt = interrupt;
+}
+
+bool MEDTester::CubicGraph::isInterrupted() const
+{
+    return mInterrupted;
+}
+
 bool MEDTester::CubicGraph::isBridgeless() {
     if (mBridgesCount == -1) countBridges(true);
     return mBridgesCount == 0;
 }
 
+bool MEDTester::CubicGraph::isBridgeless(const MEDTester::FlatAdjList& adjList)
+{
+    return countBridges(adjList, true) == 0;
+}
 
-void MEDTester::CubicGraph::assignEdge(int vertex, unsigned int index, MEDTester::EdgeType type)
+
+/* Assigns type to an unassigned edge and checks the constraints which are not local to one vertex.
+ * Cycle edges are joined into paths in a union-find which keeps the parity of each vertex relative to
+ * its root, so an odd cycle is found right when its last edge is assigned. A vertex becomes a
+ * double-star leaf vertex once it has a leaf edge and a cycle edge, and such vertices can't be
+ * adjacent. The assignment is recorded even if it violates the constraints, so the caller can always
+ * undo it with undoEdges. */
+bool MEDTester::CubicGraph::assignEdge(int vertex, unsigned int index, MEDTester::EdgeType type)
 {
-    if (mDecompositionDone) return;
+    int neighbour = mAdjList[3*vertex + index];
     mDecomposition[vertex][index] = type;
-    mDecomposition[mAdjList[vertex][index]][mAdjListIndices[mAdjList[vertex][index]][vertex]] = type;
+    mDecomposition[neighbour][mReverseIndices[3*vertex + index]] = type;
+
+    AssignedEdge assigned = {3*vertex + (int) index, -1, false, {-1, -1}};
+    bool valid = true;
+
+    if (type == MEDTester::EdgeType::CYCLE) {
+        valid = joinCycleFragments(vertex, neighbour, assigned);
+    }
+
+    if (type == MEDTester::EdgeType::CYCLE || type == MEDTester::EdgeType::STAR_LEAF) {
+        int leavesCount = 0;
+        for (int v : {vertex, neighbour}) {
+            if (mLeafVertices[v] || !isLeafVertex(v)) continue;
+            mLeafVertices[v] = true;
+            assigned.leafVertices[leavesCount++] = v;
+            for (int i = 0; i < 3; ++i) {
+                if (mLeafVertices[mAdjList[3*v + i]]) valid = false;
+            }
+        }
+    }
+
+    mAssignedEdges.push_back(assigned);
+    return valid;
+}
+
+void MEDTester::CubicGraph::undoEdges(size_t assignedCount)
+{
+    while (mAssignedEdges.size() > assignedCount) {
+        const AssignedEdge& assigned = mAssignedEdges.back();
+
+        int vertex = assigned.slot / 3;
+        int index = assigned.slot % 3;
+        mDecomposition[vertex][index] = MEDTester::EdgeType::NONE;
+        mDecomposition[mAdjList[assigned.slot]][mReverseIndices[assigned.slot]] = MEDTester::EdgeType::NONE;
+
+        if (assigned.attachedRoot != -1) {
+            int root = assigned.attachedRoot;
+            if (assigned.rankIncreased) --mCycleRanks[mCycleParents[root]];
+            mCycleParents[root] = root;
+            mCycleParities[root] = 0;
+        }
+
+        for (int v : assigned.leafVertices) {
+            if (v != -1) mLeafVertices[v] = false;
+        }
+
+        mAssignedEdges.pop_back();
+    }
+}
+
+/* Joins fragments of vertices u and v connected by a new cycle edge. If they are already in the same
+ * fragment, the edge closes a cycle, which is even only if the path between u and v has odd length.
+ * Union by rank without path compression keeps the trees shallow and every union can be undone just
+ * by detaching the attached root. */
+bool MEDTester::CubicGraph::joinCycleFragments(int u, int v, AssignedEdge& assigned)
+{
+    int parityU, parityV;
+    int rootU = findCycleRoot(u, parityU);
+    int rootV = findCycleRoot(v, parityV);
+
+    if (rootU == rootV) return parityU != parityV;
+
+    if (mCycleRanks[rootU] < mCycleRanks[rootV]) {
+        std::swap(rootU, rootV);
+        std::swap(parityU, parityV);
+    }
+
+    mCycleParents[rootV] = rootU;
+    mCycleParities[rootV] = parityU ^ parityV ^ 1;
+    assigned.attachedRoot = rootV;
+    if (mCycleRanks[rootU] == mCycleRanks[rootV]) {
+        ++mCycleRanks[rootU];
+        assigned.rankIncreased = true;
+    }
+    return true;
+}
+
+int MEDTester::CubicGraph::findCycleRoot(int vertex, int& parity) const
+{
+    parity = 0;
+    while (mCycleParents[vertex] != vertex) {
+        parity ^= mCycleParities[vertex];
+        vertex = mCycleParents[vertex];
+    }
+    return vertex;
+}
+
+bool MEDTester::CubicGraph::isLeafVertex(int vertex) const
+{
+    bool hasLeafEdge = false;
+    bool hasCycleEdge = false;
+    for (int i = 0; i < 3; ++i) {
+        hasLeafEdge |= mDecomposition[vertex][i] == MEDTester::EdgeType::STAR_LEAF;
+        hasCycleEdge |= mDecomposition[vertex][i] == MEDTester::EdgeType::CYCLE;
+    }
+    return hasLeafEdge && hasCycleEdge;
 }
 
 void MEDTester::CubicGraph::generateDecomposition(int vertex, bool counting)
 {
-    mDecomposition = MEDTester::Decomposition(mVerticesCount, std::vector<MEDTester::EdgeType>(3, MEDTester::EdgeType::NONE));
+    mDecomposition.resize(mVerticesCount);
+    for (std::vector<MEDTester::EdgeType>& types : mDecomposition) types.assign(3, MEDTester::EdgeType::NONE);
+    mAssignedEdges.clear();
+    mAssignedEdges.reserve(mEdgesCount);
+    mCycleParents.resize(mVerticesCount);
+    for (int v = 0; v < mVerticesCount; ++v) mCycleParents[v] = v;
+    mCycleParities.assign(mVerticesCount, 0);
+    mCycleRanks.assign(mVerticesCount, 0);
+    mLeafVertices.assign(mVerticesCount, false);
     mDecompositionDone = false;
     std::vector<int> vertices = dfs(vertex);
     if (counting) mDecompositionsCount = 0;
@@ -178,36 +365,49 @@ void MEDTester::CubicGraph::generateDecomposition(int vertex, bool counting)
     if (!counting) mDecompositionDone = true;
 }
 
+/* Assigns the edges of one vertex in each branch. Every assignment is checked right away (see
+ * assignEdge), so a complete assignment is always a decomposition. Before trying another option, the
+ * assignments of the previous one are undone. Once a decomposition is found (and we are not counting),
+ * the search stops and the assignment is kept. An interrupted search stops the same way, but with
+ * an incomplete assignment. */
 void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<int>& vertices, bool counting)
 {
     if (mDecompositionDone) return;
+    if (mInterrupt && mInterrupt->load(std::memory_order_relaxed)) {
+        mInterrupted = true;
+        mDecompositionDone = true;
+        return;
+    }
     
     if (index >= vertices.size()) {
-        if (checkCycles() && checkDoubleStars()) {
-            if (counting) ++mDecompositionsCount;
-            else mDecompositionDone = true;
-        }
+        if (counting) ++mDecompositionsCount;
+        else mDecompositionDone = true;
         return;
     }
 
     int v = vertices[index];
-    std::vector<int> unassigned;
-    std::vector<int> edgeTypesCount(5, 0);
+    int unassigned[3];
+    int unassignedCount = 0;
+    int edgeTypesCount[5] = {0};
+    size_t assignedCount = mAssignedEdges.size();
 
     for (int i = 0; i < 3; i++) {
         if (mDecomposition[v][i] == MEDTester::EdgeType::NONE) {
-            unassigned.push_back(i);
+            unassigned[unassignedCount++] = i;
         }
         ++edgeTypesCount[(int) mDecomposition[v][i]];
     }
 
     if (edgeTypesCount[0] == 3) {
         for (const std::vector<MEDTester::EdgeType>& colors : VERTEX_COLORINGS) {
-            for (int r = 0; r < 3 && !mDecompositionDone; ++r) {
-                for (int i = 0; i < 3; ++i) {
-                    assignEdge(0, i, colors[(i+r) % 3]);
+            for (int r = 0; r < 3; ++r) {
+                bool valid = true;
+                for (int i = 0; i < 3 && valid; ++i) {
+                    valid = assignEdge(v, i, colors[(i+r) % 3]);
                 }
-                decompositionHelper(index + 1, vertices, counting);
+                if (valid) decompositionHelper(index + 1, vertices, counting);
+                if (mDecompositionDone) return;
+                undoEdges(assignedCount);
             }
         }
     }
@@ -216,10 +416,11 @@ void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<
      * is still "correct". If it is, then we determine on which "side" of double-star leaf edge
      * is this vertex. */
     if (edgeTypesCount[3]) {
-        std::vector<int> leafEdges;
+        int leafEdges[3];
+        int leafEdgesCount = 0;
         for (int i = 0; i < 3; ++i) {
             if (mDecomposition[v][i] == MEDTester::EdgeType::STAR_LEAF) {
-                leafEdges.push_back(i);
+                leafEdges[leafEdgesCount++] = i;
             }
         }
 
@@ -227,10 +428,11 @@ void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<
          * double-star center edge. */
         if (edgeTypesCount[2]) {
             if (edgeTypesCount[0] + edgeTypesCount[2] + edgeTypesCount[3] != 3 || edgeTypesCount[3] == 2) return;
-            for (int i : leafEdges) {
+            for (int k = 0; k < leafEdgesCount; ++k) {
+                int i = leafEdges[k];
                 bool checked = false;
                 for (int j = 0; j < 3; ++j) {
-                    if (mDecomposition[mAdjList[v][i]][j] == MEDTester::EdgeType::STAR_CENTER) {
+                    if (mDecomposition[mAdjList[3*v + i]][j] == MEDTester::EdgeType::STAR_CENTER) {
                         checked = true;
                         break;
                     }
@@ -238,18 +440,22 @@ void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<
                 if (!checked) return;
             }
             
-            for (int i : unassigned) assignEdge(v, i, MEDTester::EdgeType::CYCLE);
-            decompositionHelper(index + 1, vertices, counting);
+            bool valid = true;
+            for (int k = 0; k < unassignedCount; ++k) valid = valid && assignEdge(v, unassigned[k], MEDTester::EdgeType::CYCLE);
+            if (valid) decompositionHelper(index + 1, vertices, counting);
+            if (mDecompositionDone) return;
+            undoEdges(assignedCount);
         }
 
         /* If another edge is double-star center edge, then the double-star leaf edge should be
          * adjacent to double-star center edge. */
         else if (edgeTypesCount[4]) {
             if (edgeTypesCount[0] + edgeTypesCount[3] + edgeTypesCount[4] != 3 || edgeTypesCount[4] == 2) return;
-            for (int i : leafEdges) {
+            for (int k = 0; k < leafEdgesCount; ++k) {
+                int i = leafEdges[k];
                 bool checked = false;
                 for (int j = 0; j < 3; ++j) {
-                    if (mDecomposition[mAdjList[v][i]][j] == MEDTester::EdgeType::CYCLE) {
+                    if (mDecomposition[mAdjList[3*v + i]][j] == MEDTester::EdgeType::CYCLE) {
                         checked = true;
                         break;
                     }
@@ -257,8 +463,11 @@ void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<
                 if (!checked) return;
             }
 
-            for (int i : unassigned) assignEdge(v, i, MEDTester::EdgeType::STAR_LEAF);
-            decompositionHelper(index + 1, vertices, counting);
+            bool valid = true;
+            for (int k = 0; k < unassignedCount; ++k) valid = valid && assignEdge(v, unassigned[k], MEDTester::EdgeType::STAR_LEAF);
+            if (valid) decompositionHelper(index + 1, vertices, counting);
+            if (mDecompositionDone) return;
+            undoEdges(assignedCount);
         }
 
         /* Else the should be only double-star leaf edges and uncoclored edges - no matching edge - and also not
@@ -269,13 +478,14 @@ void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<
             bool starLeafVertex = true;
             bool starCenterVertex = true;
 
-            for (int i : leafEdges) {
+            for (int k = 0; k < leafEdgesCount; ++k) {
+                int i = leafEdges[k];
                 for (int j = 0; j < 3; ++j) {
-                    if (mDecomposition[mAdjList[v][i]][j] == MEDTester::EdgeType::CYCLE) {
+                    if (mDecomposition[mAdjList[3*v + i]][j] == MEDTester::EdgeType::CYCLE) {
                         starLeafVertex = false;
                         break;
                     }
-                    if (mDecomposition[mAdjList[v][i]][j] == MEDTester::EdgeType::STAR_CENTER) {
+                    if (mDecomposition[mAdjList[3*v + i]][j] == MEDTester::EdgeType::STAR_CENTER) {
                         starCenterVertex = false;
                         break;
                     }
@@ -283,23 +493,32 @@ void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<
             }
 
             if (starLeafVertex && edgeTypesCount[0] == 2) {
-                for (int i : unassigned) assignEdge(v, i, MEDTester::EdgeType::CYCLE);
-                decompositionHelper(index + 1, vertices, counting);
+                bool valid = true;
+                for (int k = 0; k < unassignedCount; ++k) valid = valid && assignEdge(v, unassigned[k], MEDTester::EdgeType::CYCLE);
+                if (valid) decompositionHelper(index + 1, vertices, counting);
+                if (mDecompositionDone) return;
+                undoEdges(assignedCount);
             }
 
             if (starCenterVertex) {
                 if (edgeTypesCount[0] == 1) {
-                    assignEdge(v, unassigned[0], MEDTester::EdgeType::STAR_CENTER);
-                    decompositionHelper(index + 1, vertices, counting);
+                    if (assignEdge(v, unassigned[0], MEDTester::EdgeType::STAR_CENTER)) {
+                        decompositionHelper(index + 1, vertices, counting);
+                    }
+                    if (mDecompositionDone) return;
+                    undoEdges(assignedCount);
                 }
                 else {
-                    assignEdge(v, unassigned[0], MEDTester::EdgeType::STAR_CENTER);
-                    assignEdge(v, unassigned[1], MEDTester::EdgeType::STAR_LEAF);
-                    decompositionHelper(index + 1, vertices, counting);
+                    if (assignEdge(v, unassigned[0], MEDTester::EdgeType::STAR_CENTER) && assignEdge(v, unassigned[1], MEDTester::EdgeType::STAR_LEAF)) {
+                        decompositionHelper(index + 1, vertices, counting);
+                    }
                     if (mDecompositionDone) return;
-                    assignEdge(v, unassigned[0], MEDTester::EdgeType::STAR_LEAF);
-                    assignEdge(v, unassigned[1], MEDTester::EdgeType::STAR_CENTER);
-                    decompositionHelper(index + 1, vertices, counting);
+                    undoEdges(assignedCount);
+                    if (assignEdge(v, unassigned[0], MEDTester::EdgeType::STAR_LEAF) && assignEdge(v, unassigned[1], MEDTester::EdgeType::STAR_CENTER)) {
+                        decompositionHelper(index + 1, vertices, counting);
+                    }
+                    if (mDecompositionDone) return;
+                    undoEdges(assignedCount);
                 }
             }
         }
@@ -309,26 +528,35 @@ void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<
      * double-star leaf edges. */
     else if (edgeTypesCount[4]) {
         if (edgeTypesCount[0] != 2) return;
-        for (int i : unassigned) assignEdge(v, i, MEDTester::EdgeType::STAR_LEAF);
-        decompositionHelper(index + 1, vertices, counting);
+        bool valid = true;
+        for (int k = 0; k < unassignedCount; ++k) valid = valid && assignEdge(v, unassigned[k], MEDTester::EdgeType::STAR_LEAF);
+        if (valid) decompositionHelper(index + 1, vertices, counting);
+        if (mDecompositionDone) return;
+        undoEdges(assignedCount);
     }
 
     /* If one edge is a matching edge, then other two edges must be in a cycle. */
     else if (edgeTypesCount[1] == 1 && edgeTypesCount[0] + edgeTypesCount[2] == 2) {
-        for (int i : unassigned) {
-            assignEdge(v, i, MEDTester::EdgeType::CYCLE);
-        }
-        decompositionHelper(index + 1, vertices, counting);
+        bool valid = true;
+        for (int k = 0; k < unassignedCount; ++k) valid = valid && assignEdge(v, unassigned[k], MEDTester::EdgeType::CYCLE);
+        if (valid) decompositionHelper(index + 1, vertices, counting);
+        if (mDecompositionDone) return;
+        undoEdges(assignedCount);
     }
 
     /* If two edges are in a cycle, then the remaining one must be either a matching edge or
      * a double-star leaf edge (and also is uncolored, because of previous checks). */
     else if (edgeTypesCount[2] == 2 && edgeTypesCount[0]) {
-        assignEdge(v, unassigned[0], MEDTester::EdgeType::MATCHING);
-        decompositionHelper(index + 1, vertices, counting);
+        if (assignEdge(v, unassigned[0], MEDTester::EdgeType::MATCHING)) {
+            decompositionHelper(index + 1, vertices, counting);
+        }
         if (mDecompositionDone) return;
-        assignEdge(v, unassigned[0], MEDTester::EdgeType::STAR_LEAF);
-        decompositionHelper(index + 1, vertices, counting);
+        undoEdges(assignedCount);
+        if (assignEdge(v, unassigned[0], MEDTester::EdgeType::STAR_LEAF)) {
+            decompositionHelper(index + 1, vertices, counting);
+        }
+        if (mDecompositionDone) return;
+        undoEdges(assignedCount);
     }
 
     /* If one edge is in a cycle and two edges are not colored, then one of them must be in a cycle and
@@ -336,125 +564,118 @@ void MEDTester::CubicGraph::decompositionHelper(unsigned int index, std::vector<
     else if (edgeTypesCount[2] == 1 && edgeTypesCount[0] == 2) {
         MEDTester::EdgeType option[] = {MEDTester::EdgeType::MATCHING, MEDTester::EdgeType::STAR_LEAF};
         for (int i = 0; i < 2; i++) {
-            assignEdge(v, unassigned.at(i), MEDTester::EdgeType::CYCLE);
             for (int j = 0; j < 2; j++) {
-                assignEdge(v, unassigned.at((i+1)%2), option[j]);
-                decompositionHelper(index + 1, vertices, counting);
+                if (assignEdge(v, unassigned[i], MEDTester::EdgeType::CYCLE) && assignEdge(v, unassigned[(i+1)%2], option[j])) {
+                    decompositionHelper(index + 1, vertices, counting);
+                }
                 if (mDecompositionDone) return;
+                undoEdges(assignedCount);
             }
         }
     }
-
-    if (!mDecompositionDone) {
-        for (int i : unassigned) assignEdge(v, i, MEDTester::EdgeType::NONE);
-    }
 }
 
 
-bool MEDTester::CubicGraph::checkCycles() const
+void MEDTester::CubicGraph::countBridges(bool findOnlyOne)
 {
-    std::vector<bool> checked(mVerticesCount, false);
-
-    for (int v = 0; v < mVerticesCount; v++) {
-        if (!checked[v]) {
-            checked[v] = true;
-            bool isCycle = false;
-            int next = -1;
-            for (int j = 0; j < 3; j++) {
-                if (mDecomposition[v][j] == MEDTester::EdgeType::CYCLE) {
-                    isCycle = true;
-                    next = mAdjList[v][j];
-                    break;
-                }
-            }
-            if (isCycle) {
-                int length = 1;
-                int prev = v;
-                int maxIter = mVerticesCount;
-                while (next != v && maxIter--) {
-                    checked[next] = true;
-                    length++;
-                    for (int j = 0; j < 3; j++) {
-                        if (mDecomposition[next][j] == MEDTester::EdgeType::CYCLE && mAdjList[next][j] != prev) {
-                            prev = next;
-                            next = mAdjList[next][j];
-                            break;
-                        }
-                    }
-                }
-                if (length % 2 == 1 || maxIter == 0) {
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
+    mBridgesCount = countBridges(mAdjList, findOnlyOne);
+    if (!findOnlyOne || mBridgesCount == 0) mAllBridgesFound = true;
 }
 
-bool MEDTester::CubicGraph::checkDoubleStars() const
+/* Tarjan's low-link search with an explicit stack (see dfs). The low value of a vertex is passed to
+ * its parent when the vertex is popped, and the edge to the parent is a bridge if nothing below it
+ * reaches above the parent. It needs only the adjacency list, so graphs can be filtered before a
+ * CubicGraph is built for them. */
+int MEDTester::CubicGraph::countBridges(const MEDTester::FlatAdjList& adjList, bool findOnlyOne)
 {
-    std::unordered_set<int> leafVertices;
+    int verticesCount = adjList.size() / 3;
+    int bridgesCount = 0;
+    TraversalWorkspace& workspace = getWorkspace();
+    workspace.reset(verticesCount);
+    std::vector<int>& disc = workspace.disc;
+    std::vector<int>& low = workspace.low;
+    std::vector<int>& parents = workspace.parents;
+    std::vector<uint8_t>& nextIndices = workspace.nextIndices;
+    std::vector<int>& stack = workspace.stack;
+    disc.assign(verticesCount, 0);
+    int time = 0;
 
-    for (int v = 0; v < mVerticesCount; v++) {
-        bool isLeafVertex = false;
-        for (int i = 0; i < 3; i++) {
-            if (mDecomposition[v][i] == MEDTester::EdgeType::STAR_CENTER) {
-                isLeafVertex = false;
-                break;
-            }
-            if (mDecomposition[v][i] == MEDTester::EdgeType::STAR_LEAF) {
-                isLeafVertex = true;
+    for (int root = 0; root < verticesCount; ++root) {
+        if (disc[root] != 0) continue;
+        disc[root] = low[root] = ++time;
+        parents[root] = -1;
+        nextIndices[root] = 0;
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            int u = stack.back();
+            if (nextIndices[u] < 3) {
+                int v = adjList[3*u + nextIndices[u]++];
+                if (v == parents[u]) continue;
+
+                if (disc[v] != 0) {
+                    low[u] = std::min(low[u], disc[v]);
+                }
+                else {
+                    disc[v] = low[v] = ++time;
+                    parents[v] = u;
+                    nextIndices[v] = 0;
+                    stack.push_back(v);
+                }
+                continue;
             }
-        }
-        if (isLeafVertex) {
-            for (int i = 0; i < 3; i++) {
-                if (leafVertices.find(mAdjList[v][i]) != leafVertices.end()) {
-                    return false;
+
+            stack.pop_back();
+            int parent = parents[u];
+            if (parent < 0) continue;
+            low[parent] = std::min(low[parent], low[u]);
+            if (low[u] > disc[parent]) {
+                ++bridgesCount;
+                if (findOnlyOne) {
+                    stack.clear();
+                    return bridgesCount;
                 }
             }
-            leafVertices.insert(v);
         }
     }
-    return true;
+    return bridgesCount;
 }
 
 
-void MEDTester::CubicGraph::countBridges(bool findOnlyOne)
+MEDTester::CubicGraph::TraversalWorkspace& MEDTester::CubicGraph::getWorkspace()
 {
-    mBridgesCount = 0;
-    std::vector<bool> visited(mVerticesCount, false);
-    std::vector<int> disc(mVerticesCount, -1);
-    std::vector<int> low(mVerticesCount, -1);
-    int time = 0;
+    thread_local TraversalWorkspace workspace;
+    return workspace;
+}
 
-    for (int v = 0; v < mVerticesCount; ++v) {
-        if (visited[v] == false) {
-            countBridgesHelper(v, -1, visited, disc, low, &time, findOnlyOne);
-        }
+/* Only the bitmap is cleared, the other arrays are written before they are read. */
+void MEDTester::CubicGraph::TraversalWorkspace::reset(int verticesCount)
+{
+    visited.assign((verticesCount + 63) / 64, 0);
+    stack.clear();
+    if ((int) parents.size() < verticesCount) {
+        parents.resize(verticesCount);
+        nextIndices.resize(verticesCount);
+        low.resize(verticesCount);
     }
 }
 
-void MEDTester::CubicGraph::countBridgesHelper(int vertex, int parent, std::vector<bool>& visited, std::vector<int>& disc, std::vector<int>& low, int *time, bool findOnlyOne)
+bool MEDTester::CubicGraph::TraversalWorkspace::visit(int vertex)
 {
-    visited[vertex] = true;
-    disc[vertex] = low[vertex] = ++*time;
-
-    for (int i = 0; i < 3; ++i) {
-        if (findOnlyOne && mBridgesCount) return;
+    uint64_t bit = uint64_t(1) << (vertex & 63);
+    if (visited[vertex >> 6] & bit) return false;
+    visited[vertex >> 6] |= bit;
+    return true;
+}
 
-        int v = mAdjList[vertex][i];
-        if (v == parent) continue;
 
-        if (visited[v]) {
-            low[vertex] = std::min(low[vertex], disc[v]);
-        }
-        else {
-            countBridgesHelper(v, vertex, visited, disc, low, time, findOnlyOne);
-            low[vertex] = std::min(low[vertex], low[v]);
-            if (low[v] > disc[vertex]) {
-                ++mBridgesCount;
-                if (findOnlyOne) return;
-            }
+MEDTester::FlatAdjList MEDTester::CubicGraph::toFlatAdjList(const MEDTester::Matrix& adjList)
+{
+    MEDTester::FlatAdjList flat(3 * adjList.size());
+    for (size_t u = 0; u < adjList.size(); ++u) {
+        for (int i = 0; i < 3; ++i) {
+            flat[3*u + i] = adjList[u][i];
         }
     }
+    return flat;
 }
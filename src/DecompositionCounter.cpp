@@ -0,0 +1,265 @@
+#include "DecompositionCounter.h"
+
+#include "CubicGraph.h"
+#include "typedefs.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+#include <utility>
+
+
+MEDTester::DecompositionCounter::DecompositionCounter(const MEDTester::CubicGraph& graph) : mGraph(graph)
+{
+    mCounted = false;
+    mDecompositionsCount = 0;
+}
+
+MEDTester::DecompositionCounter::~DecompositionCounter() {}
+
+
+uint64_t MEDTester::DecompositionCounter::getDecompositionsCount()
+{
+    if (!mCounted) count();
+    return mDecompositionsCount;
+}
+
+
+const int MEDTester::DecompositionCounter::ORDER_ROOTS_COUNT = 32;
+
+
+/* Number of states grows exponentially with the width of the frontier, so greedy orders starting
+ * from several vertices are compared and the one with the narrowest frontier (and then the smallest
+ * total size of frontiers) is used. */
+std::vector<int> MEDTester::DecompositionCounter::getVertexOrder() const
+{
+    int verticesCount = mGraph.getVerticesCount();
+    int rootsCount = std::min(verticesCount, ORDER_ROOTS_COUNT);
+    std::vector<int> bestOrder;
+    std::pair<int, long> bestWidth(INT_MAX, LONG_MAX);
+
+    for (int i = 0; i < rootsCount; ++i) {
+        std::pair<int, long> width;
+        std::vector<int> order = getGreedyOrder((long) i * verticesCount / rootsCount, width);
+        if (width < bestWidth) {
+            bestWidth = width;
+            bestOrder.swap(order);
+        }
+    }
+
+    return bestOrder;
+}
+
+/* The next vertex is the one with the most processed neighbours (it removes the most edges from
+ * the frontier and adds the fewest), on a tie the one reached first. */
+std::vector<int> MEDTester::DecompositionCounter::getGreedyOrder(int root, std::pair<int, long>& width) const
+{
+    int verticesCount = mGraph.getVerticesCount();
+    std::vector<int> order;
+    std::vector<int> reached;
+    std::vector<int> processedNeighbours(verticesCount, 0);
+    std::vector<bool> isReached(verticesCount, false);
+    order.reserve(verticesCount);
+    width = {0, 0};
+    int frontierSize = 0;
+
+    for (int i = 0; i < verticesCount; ++i) {
+        int start = (root + i) % verticesCount;
+        if (isReached[start]) continue;
+        isReached[start] = true;
+        reached.push_back(start);
+
+        while (!reached.empty()) {
+            size_t best = 0;
+            for (size_t k = 1; k < reached.size(); ++k) {
+                if (processedNeighbours[reached[k]] > processedNeighbours[reached[best]]) best = k;
+            }
+            int v = reached[best];
+            reached.erase(reached.begin() + best);
+            order.push_back(v);
+
+            frontierSize += 3 - 2*processedNeighbours[v];
+            width.first = std::max(width.first, frontierSize);
+            width.second += frontierSize;
+
+            for (int j = 0; j < 3; ++j) {
+                int w = mGraph.getNeighbour(v, j);
+                ++processedNeighbours[w];
+                if (!isReached[w]) {
+                    isReached[w] = true;
+                    reached.push_back(w);
+                }
+            }
+        }
+    }
+
+    return order;
+}
+
+void MEDTester::DecompositionCounter::count()
+{
+    int verticesCount = mGraph.getVerticesCount();
+    std::vector<int> order = getVertexOrder();
+    std::vector<bool> processed(verticesCount, false);
+    std::vector<int> frontier;
+    std::vector<int> frontierPositions(mGraph.getEdgesCount(), -1);
+
+    std::unordered_map<FrontierState, uint64_t> states;
+    std::unordered_map<FrontierState, uint64_t> nextStates;
+    states[FrontierState()] = 1;
+
+    mCounted = true;
+    mDecompositionsCount = 0;
+
+    for (int v : order) {
+        std::vector<int> inPositions(3, -1);
+        std::vector<int> outPositions(3, -1);
+        std::vector<int> newPositions(frontier.size(), -1);
+        std::vector<int> nextFrontier;
+        nextFrontier.reserve(frontier.size() + 3);
+
+        for (int i = 0; i < 3; ++i) {
+            if (processed[mGraph.getNeighbour(v, i)]) inPositions[i] = frontierPositions[mGraph.getEdgeId(v, i)];
+        }
+        for (size_t k = 0; k < frontier.size(); ++k) {
+            if ((int) k == inPositions[0] || (int) k == inPositions[1] || (int) k == inPositions[2]) continue;
+            newPositions[k] = nextFrontier.size();
+            nextFrontier.push_back(frontier[k]);
+        }
+        for (int i = 0; i < 3; ++i) {
+            if (inPositions[i] != -1) continue;
+            outPositions[i] = nextFrontier.size();
+            nextFrontier.push_back(mGraph.getEdgeId(v, i));
+        }
+
+        nextStates.clear();
+        processVertex(inPositions, outPositions, newPositions, states, nextStates, nextFrontier.size());
+        states.swap(nextStates);
+        if (states.empty()) return;
+
+        for (int e : frontier) frontierPositions[e] = -1;
+        for (size_t k = 0; k < nextFrontier.size(); ++k) frontierPositions[nextFrontier[k]] = k;
+        frontier.swap(nextFrontier);
+        processed[v] = true;
+    }
+
+    mDecompositionsCount = states[FrontierState()];
+}
+
+/* Tries all 9 possible types of edges around the vertex (MCC, HCC and SHH in each rotation) on
+ * every frontier state. Edges to processed vertices must agree with the types required by their
+ * other endpoints, cycle edges are joined into longer paths and a path closed into a cycle must
+ * have even length. */
+void MEDTester::DecompositionCounter::processVertex(const std::vector<int>& inPositions, const std::vector<int>& outPositions,
+                                                    const std::vector<int>& newPositions, const std::unordered_map<MEDTester::DecompositionCounter::FrontierState, uint64_t>& states,
+                                                    std::unordered_map<MEDTester::DecompositionCounter::FrontierState, uint64_t>& nextStates, size_t nextFrontierSize) const
+{
+    static const MEDTester::EdgeType SPECIAL_EDGE[] = {MEDTester::EdgeType::MATCHING, MEDTester::EdgeType::STAR_LEAF, MEDTester::EdgeType::STAR_CENTER};
+    static const MEDTester::EdgeType OTHER_EDGES[] = {MEDTester::EdgeType::CYCLE, MEDTester::EdgeType::CYCLE, MEDTester::EdgeType::STAR_LEAF};
+
+    auto link = [] (FrontierState& state, int p, int q, uint32_t parity) {
+        state[p] = (state[p] & 7) | (parity << 3) | ((uint32_t) q << 4);
+        state[q] = (state[q] & 7) | (parity << 3) | ((uint32_t) p << 4);
+    };
+
+    /* The part of the next state inherited from the current one is the same for all types of the
+     * edges around the vertex, so it is built only once. Both buffers are reused, a new key is
+     * allocated only when it is inserted into the map. */
+    FrontierState base;
+    FrontierState next;
+
+    for (const auto& [state, count] : states) {
+        base.assign(nextFrontierSize, 0);
+        for (size_t p = 0; p < state.size(); ++p) {
+            uint32_t x = state[p];
+            if (newPositions[p] == -1) continue;
+            if ((x & 7) >= CYCLE && newPositions[x >> 4] != -1) x = (x & 15) | ((uint32_t) newPositions[x >> 4] << 4);
+            base[newPositions[p]] = x;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            VertexKind kind = (VertexKind) k;
+
+            for (int r = 0; r < 3; ++r) {
+                MEDTester::EdgeType slotTypes[3];
+                for (int i = 0; i < 3; ++i) slotTypes[i] = i == r ? SPECIAL_EDGE[kind] : OTHER_EDGES[kind];
+
+                bool valid = true;
+                for (int i = 0; i < 3 && valid; ++i) {
+                    if (inPositions[i] != -1) valid = isCompatible(state[inPositions[i]] & 7, kind, slotTypes[i]);
+                }
+                if (!valid) continue;
+
+                next = base;
+
+                int cycleSlots[2];
+                int cycleSlotsCount = 0;
+                for (int i = 0; i < 3; ++i) {
+                    if (slotTypes[i] == MEDTester::EdgeType::CYCLE) cycleSlots[cycleSlotsCount++] = i;
+                    if (outPositions[i] == -1) continue;
+
+                    switch (slotTypes[i]) {
+                    case MEDTester::EdgeType::MATCHING:
+                        next[outPositions[i]] = MATCHING;
+                        break;
+                    case MEDTester::EdgeType::STAR_CENTER:
+                        next[outPositions[i]] = STAR_CENTER;
+                        break;
+                    case MEDTester::EdgeType::STAR_LEAF:
+                        next[outPositions[i]] = kind == CENTER_VERTEX ? LEAF_FROM_CENTER : LEAF_FROM_LEAF;
+                        break;
+                    default:
+                        next[outPositions[i]] = kind == LEAF_VERTEX ? CYCLE_FROM_LEAF : CYCLE;
+                        break;
+                    }
+                }
+
+                if (cycleSlotsCount == 2) {
+                    int a = cycleSlots[0];
+                    int b = cycleSlots[1];
+                    if (inPositions[a] == -1) std::swap(a, b);
+
+                    if (inPositions[a] == -1) {
+                        link(next, outPositions[a], outPositions[b], 0);
+                    }
+                    else if (inPositions[b] == -1) {
+                        uint32_t x = state[inPositions[a]];
+                        link(next, newPositions[x >> 4], outPositions[b], ((x >> 3) & 1) ^ 1);
+                    }
+                    else {
+                        uint32_t x = state[inPositions[a]];
+                        uint32_t y = state[inPositions[b]];
+                        if ((int) (x >> 4) == inPositions[b]) {
+                            if ((x >> 3) & 1) continue;
+                        } else {
+                            link(next, newPositions[x >> 4], newPositions[y >> 4], ((x >> 3) & 1) ^ ((y >> 3) & 1));
+                        }
+                    }
+                }
+
+                nextStates[next] += count;
+            }
+        }
+    }
+}
+
+bool MEDTester::DecompositionCounter::isCompatible(uint32_t type, MEDTester::DecompositionCounter::VertexKind kind, MEDTester::EdgeType slotType)
+{
+    switch (type) {
+    case MATCHING:
+        return slotType == MEDTester::EdgeType::MATCHING;
+    case STAR_CENTER:
+        return slotType == MEDTester::EdgeType::STAR_CENTER;
+    case LEAF_FROM_CENTER:
+        return slotType == MEDTester::EdgeType::STAR_LEAF && kind == LEAF_VERTEX;
+    case LEAF_FROM_LEAF:
+        return slotType == MEDTester::EdgeType::STAR_LEAF && kind == CENTER_VERTEX;
+    case CYCLE:
+        return slotType == MEDTester::EdgeType::CYCLE;
+    default:
+        return slotType == MEDTester::EdgeType::CYCLE && kind != LEAF_VERTEX;
+    }
+}
@@ -1,34 +1,48 @@
 #include "GraphAnalyser.h"
 
-#ifdef SAT
-    #include "SatSolver.h"
-#else
-    #include "CubicGraph.h"
-#endif
+#include "SatSolver.h"
+#include "Reducer.h"
+#include "CubicGraph.h"
+
+#include "TaitColoring.h"
+#include "DecompositionCounter.h"
+#include "CanonicalForm.h"
+#include "ResultCache.h"
+#include "OutputWriter.h"
+#include "ResultReader.h"
+#include "Profiler.h"
+#include "Portfolio.h"
 
 #include "typedefs.h"
 #include "OutputMode.h"
+#include "Engine.h"
+#include "InputFormat.h"
+#include "Encoding.h"
 #include "Parser.h"
+#include "BlockingQueue.h"
+#include "ReorderBuffer.h"
 
 #include <string>
 #include <vector>
-#include <unordered_set>
-#include <unordered_map>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <filesystem>
+#include <memory>
 #include <chrono>
 #include <cmath>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
 
 
-const std::unordered_map<MEDTester::EdgeType, std::string> MEDTester::GraphAnalyser::EDGE_TYPE_CHAR = {
-    {MEDTester::EdgeType::NONE, "-"},
-    {MEDTester::EdgeType::MATCHING, "M"},
-    {MEDTester::EdgeType::CYCLE, "C"},
-    {MEDTester::EdgeType::STAR_LEAF, "H"},
-    {MEDTester::EdgeType::STAR_CENTER, "S"}
-};
+const unsigned int MEDTester::GraphAnalyser::DEFAULT_CHECKPOINT_INTERVAL = 10;
+const std::string MEDTester::GraphAnalyser::CHECKPOINT_FILE_SUFFIX = ".checkpoint";
+const std::string MEDTester::GraphAnalyser::CHECKPOINT_FILE_HEADER = "med-checkpoint 1";
 
 MEDTester::GraphAnalyser::GraphAnalyser(MEDTester::Parser& parser)
 {
@@ -40,15 +54,49 @@ MEDTester::GraphAnalyser::GraphAnalyser(MEDTester::Parser& parser)
     mOutputMode = parser.getOutputMode();
     mOnlyBridgeless = parser.getOnlyBridgeless();
     mShowTime = parser.getShowTime();
+    mThreadsCount = parser.getThreadsCount();
+    mUseSolverPool = parser.getUseSolverPool();
+    mShowStats = parser.getShowStats();
+    mEngine = parser.getEngine();
+    mUseCache = parser.getUseCache();
+    mShardIndex = parser.getShardIndex();
+    mShardsCount = parser.getShardsCount();
+    mInputFormat = parser.getInputFormat();
+    mStreaming = parser.getStreaming();
+    mWithAdjacency = parser.getWithAdjacency();
+    mCheckpointInterval = parser.getCheckpointInterval();
+    mResume = parser.getResume();
+    mProfileFilename = parser.getProfileFilename();
+    mPortfolioThreshold = parser.getPortfolioThreshold();
+    mEncoding = parser.getEncoding();
+    mReduce = parser.getReduce();
+    if (mResume && mCheckpointInterval == 0) mCheckpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
 }
 
-MEDTester::GraphAnalyser::GraphAnalyser(const std::string& inputFilename, const std::string& outputFilename, MEDTester::OutputMode outputMode, bool onlyBridgeless, bool showTime)
+MEDTester::GraphAnalyser::GraphAnalyser(const std::string& inputFilename, const std::string& outputFilename, MEDTester::OutputMode outputMode, bool onlyBridgeless, bool showTime, unsigned int threadsCount, bool useSolverPool, bool showStats, MEDTester::Engine engine, bool useCache, unsigned int shardIndex, unsigned int shardsCount, MEDTester::InputFormat inputFormat, bool streaming, bool withAdjacency, unsigned int checkpointInterval, bool resume, const std::string& profileFilename, unsigned int portfolioThreshold, MEDTester::Encoding encoding, bool reduce)
 {
     mInputFilename = inputFilename;
     mOutputFilename = outputFilename;
     mOutputMode = outputMode;
     mOnlyBridgeless = onlyBridgeless;
     mShowTime = showTime;
+    mThreadsCount = threadsCount > 0 ? threadsCount : 1;
+    mUseSolverPool = useSolverPool;
+    mShowStats = showStats;
+    mEngine = engine;
+    mUseCache = useCache;
+    mShardsCount = shardsCount > 0 ? shardsCount : 1;
+    mShardIndex = shardIndex % mShardsCount;
+    mInputFormat = inputFormat;
+    mStreaming = streaming;
+    mWithAdjacency = withAdjacency;
+    mCheckpointInterval = checkpointInterval;
+    mResume = resume;
+    mProfileFilename = profileFilename;
+    mPortfolioThreshold = portfolioThreshold;
+    mEncoding = encoding;
+    mReduce = reduce;
+    if (mResume && mCheckpointInterval == 0) mCheckpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
 }
 
 MEDTester::GraphAnalyser::~GraphAnalyser() {}
@@ -56,25 +104,44 @@ MEDTester::GraphAnalyser::~GraphAnalyser() {}
 
 void MEDTester::GraphAnalyser::analyze() const
 {
-    std::istream *in;
-    std::ifstream inputFile;
+    std::unique_ptr<MEDTester::InputReader> in;
     if (mInputFilename == MEDTester::Parser::INPUT_FILENAME_OPTION_INFO.defaultValue) {
-        in = &std::cin;
+        in = std::make_unique<MEDTester::InputReader>();
     } else {
         if (!std::filesystem::exists(mInputFilename)) {
             throw FileErrorException(INPUT_FILE_DOES_NOT_EXIST_MESSAGE(mInputFilename));
         }
-        inputFile.open(mInputFilename, std::ifstream::in);
-        if (!inputFile.good()) {
+        in = std::make_unique<MEDTester::InputReader>(mInputFilename);
+        if (!in->isOpen()) {
             throw FileErrorException(CANNOT_OPEN_FILE_MESSAGE(mInputFilename));
         }
-        in = &inputFile;
+    }
+
+    /* Resumed analysis continues after the last checkpoint - the input is read from the saved
+     * offset and the output written after the checkpoint is cut off. */
+    Checkpoint checkpoint;
+    if (mCheckpointInterval > 0 && mOutputFilename == MEDTester::Parser::OUTPUT_FILENAME_OPTION_INFO.defaultValue) {
+        throw FileErrorException(CHECKPOINT_NEEDS_OUTPUT_FILE_MESSAGE());
+    }
+    if (mResume) {
+        loadCheckpoint(checkpoint);
+        if (checkpoint.loaded && !in->seek(checkpoint.inputOffset)) {
+            throw FileErrorException(CANNOT_RESUME_MESSAGE(mInputFilename));
+        }
     }
 
     std::ostream *out;
     std::ofstream outputFile;
     if (mOutputFilename == MEDTester::Parser::OUTPUT_FILENAME_OPTION_INFO.defaultValue) {
         out = &std::cout;
+    } else if (checkpoint.loaded) {
+        std::error_code error;
+        std::filesystem::resize_file(mOutputFilename, checkpoint.outputOffset, error);
+        if (!error) outputFile.open(mOutputFilename, std::ofstream::in | std::ofstream::out);
+        if (!outputFile.is_open())
+            throw FileErrorException(CANNOT_OPEN_FILE_MESSAGE(mOutputFilename));
+        outputFile.seekp(checkpoint.outputOffset);
+        out = &outputFile;
     } else {
         outputFile.open(mOutputFilename, std::ofstream::out);
         if (!outputFile.is_open())
@@ -82,24 +149,223 @@ void MEDTester::GraphAnalyser::analyze() const
         out = &outputFile;
     }
 
+    /* Profile file is opened before the analysis, so a wrong path is reported right away. */
+    std::ofstream profileFile;
+    if (!mProfileFilename.empty()) {
+        profileFile.open(mProfileFilename, std::ofstream::out);
+        if (!profileFile.is_open())
+            throw FileErrorException(CANNOT_OPEN_FILE_MESSAGE(mProfileFilename));
+    }
+
     auto timeStart = std::chrono::high_resolution_clock::now();
 
+    std::unique_ptr<MEDTester::ResultCache> cache;
+    if (mUseCache) cache = std::make_unique<MEDTester::ResultCache>();
+
+    StageStats stats;
+    std::unique_ptr<MEDTester::Profiler> profiler;
+    if (!mProfileFilename.empty()) profiler = std::make_unique<MEDTester::Profiler>();
+
+    MEDTester::OutputWriter writer(*out, checkpoint.outputOffset);
+    if (mThreadsCount > 1) {
+        analyzeParallel(*in, writer, cache.get(), stats, checkpoint, profiler.get());
+    } else {
+        analyzeSerial(*in, writer, cache.get(), stats, checkpoint, profiler.get());
+    }
+    {
+        MEDTester::Profiler::Timer timer(profiler.get(), MEDTester::Profiler::OUTPUT);
+        writer.flush();
+    }
+
+    /* Text lines would break the binary output, so they go to the standard error output. */
+    std::ostream& info = mOutputMode == MEDTester::OutputMode::BINARY_COLORING ? std::cerr : *out;
+
+    auto timeEnd = std::chrono::high_resolution_clock::now();
+    if (mShowStats) {
+        writeStats(stats, info);
+    }
+    std::chrono::milliseconds executionTime = std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeStart);
+    if (mShowTime) {
+        info << "execution time: " << executionTime.count() << " milliseconds\n";
+    }
+    if (profiler) {
+        profiler->writeJson(profileFile, std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeStart).count());
+        profileFile.close();
+    }
+    
+    outputFile.close();
+}
+
+
+void MEDTester::GraphAnalyser::analyzeSerial(MEDTester::InputReader& in, MEDTester::OutputWriter& out, MEDTester::ResultCache* cache, StageStats& stats, Checkpoint& checkpoint, MEDTester::Profiler* profiler) const
+{
+    if (!checkpoint.loaded) {
+        checkpoint.graphCount = readHeader(in);
+        writeHeader(out);
+    }
+    int graphCount = checkpoint.graphCount;
+
+    WorkerContext context;
+    initContext(context, cache);
+
+    int i;
+    int graphNum;
+    MEDTester::FlatAdjList adjList;
+    for (i = checkpoint.position; ; ++i) {
+        bool owned = isOwnedGraph(i);
+        {
+            MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::PARSING);
+            if (!nextGraph(in, i, graphCount, graphNum, owned ? &adjList : nullptr)) break;
+        }
+        if (owned) {
+            analyzeGraph(context, graphNum, adjList, out);
+            if (mStreaming) out.flush();
+        }
+        saveCheckpoint(checkpoint, in.getOffset(), i + 1, out, false);
+    }
+    saveCheckpoint(checkpoint, in.getOffset(), i, out, true);
+
+    stats = context.stats;
+    if (profiler) profiler->merge(*context.profiler);
+}
+
+/* Parallel analysis is a pipeline of three stages. A reader thread parses graphs from the input
+ * and puts them into a bounded task queue, worker threads take graphs from the queue, analyse them
+ * and put their (textual) results into a reorder buffer, and the calling thread writes the results
+ * from the reorder buffer in the original order of graphs. The reader reserves a slot in the
+ * reorder buffer before reading a graph, so it can't get too far ahead of the writer. If the input
+ * is malformed, all results of graphs preceding the malformed one are written before the exception
+ * is rethrown, so the output is the same as in the serial analysis. */
+void MEDTester::GraphAnalyser::analyzeParallel(MEDTester::InputReader& in, MEDTester::OutputWriter& out, MEDTester::ResultCache* cache, StageStats& stats, Checkpoint& checkpoint, MEDTester::Profiler* profiler) const
+{
+    if (!checkpoint.loaded) {
+        checkpoint.graphCount = readHeader(in);
+        writeHeader(out);
+    }
+    int graphCount = checkpoint.graphCount;
+
+    size_t window = 64 * mThreadsCount;
+    MEDTester::BlockingQueue<GraphTask> tasks(4 * mThreadsCount);
+    MEDTester::ReorderBuffer<GraphResult> results(window);
+    std::exception_ptr readerError = nullptr;
+    std::exception_ptr workerError = nullptr;
+    std::mutex workerErrorMutex;
+
+    /* The reader thread has its own profiler, parsing can't be measured by the workers. */
+    int readerPosition = checkpoint.position;
+    std::unique_ptr<MEDTester::Profiler> readerProfiler;
+    if (profiler) readerProfiler = std::make_unique<MEDTester::Profiler>();
+    std::thread reader([&] {
+        long index = 0;
+        try {
+            for (int& i = readerPosition; ; ++i) {
+                if (!isOwnedGraph(i)) {
+                    MEDTester::Profiler::Timer timer(readerProfiler.get(), MEDTester::Profiler::PARSING);
+                    int graphNum;
+                    if (!nextGraph(in, i, graphCount, graphNum, nullptr)) break;
+                    continue;
+                }
+                if (!results.reserve(index)) break;
+                GraphTask task;
+                task.index = index;
+                task.position = i;
+                {
+                    MEDTester::Profiler::Timer timer(readerProfiler.get(), MEDTester::Profiler::PARSING);
+                    if (!nextGraph(in, i, graphCount, task.graphNum, &task.adjList)) break;
+                }
+                task.inputOffset = in.getOffset();
+                if (!tasks.push(std::move(task))) break;
+                ++index;
+            }
+        }
+        catch (...) {
+            readerError = std::current_exception();
+        }
+        results.finish(index);
+        tasks.close();
+    });
+
+    std::vector<WorkerContext> contexts(mThreadsCount);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < mThreadsCount; ++t) {
+        workers.emplace_back([&, t] {
+            WorkerContext& context = contexts[t];
+            initContext(context, cache);
+
+            MEDTester::OutputWriter result;
+            GraphTask task;
+            while (tasks.pop(task)) {
+                try {
+                    analyzeGraph(context, task.graphNum, task.adjList, result);
+                    results.put(task.index, GraphResult{ result.takeBuffer(), task.position, task.inputOffset });
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(workerErrorMutex);
+                    if (!workerError) workerError = std::current_exception();
+                    results.abort();
+                    tasks.close();
+                }
+            }
+        });
+    }
+
+    GraphResult result;
+    while (results.take(result)) {
+        {
+            MEDTester::Profiler::Timer timer(profiler, MEDTester::Profiler::OUTPUT);
+            out.write(result.output);
+            if (mStreaming) out.flush();
+        }
+        saveCheckpoint(checkpoint, result.inputOffset, result.position + 1, out, false);
+    }
+
+    reader.join();
+    for (std::thread& worker : workers) worker.join();
+    if (!workerError && !readerError) saveCheckpoint(checkpoint, in.getOffset(), readerPosition, out, true);
+
+    for (const WorkerContext& context : contexts) {
+        stats.skipped += context.stats.skipped;
+        stats.coloring += context.stats.coloring;
+        stats.cached += context.stats.cached;
+        stats.solver += context.stats.solver;
+        stats.raced += context.stats.raced;
+        stats.won += context.stats.won;
+        stats.reduced += context.stats.reduced;
+        stats.reducedVertices += context.stats.reducedVertices;
+        stats.kernelVertices += context.stats.kernelVertices;
+        if (profiler) profiler->merge(*context.profiler);
+    }
+    if (profiler) profiler->merge(*readerProfiler);
+
+    if (workerError) std::rethrow_exception(workerError);
+    if (readerError) std::rethrow_exception(readerError);
+}
+
+void MEDTester::GraphAnalyser::analyzeGraph(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const
+{
+    std::chrono::steady_clock::time_point timeStart;
+    if (context.profiler) timeStart = std::chrono::steady_clock::now();
+
     switch (mOutputMode)
     {
     case MEDTester::OutputMode::ONLY_RESULT: 
-        onlyResultMode(*in, *out);
+        onlyResultMode(context, graphNum, adjList, out);
         break;
 
     case MEDTester::OutputMode::NOT_DECOMPOSABLE: 
-        notDecomposableMode(*in, *out);
+        notDecomposableMode(context, graphNum, adjList, out);
         break;
 
     case MEDTester::OutputMode::COLORING: 
-        coloringMode(*in, *out);
+        coloringMode(context, graphNum, adjList, out);
         break;
 
     case MEDTester::OutputMode::COUNT:
-        countMode(*in, *out);
+        countMode(context, graphNum, adjList, out);
+        break;
+
+    case MEDTester::OutputMode::BINARY_COLORING:
+        binaryColoringMode(context, graphNum, adjList, out);
         break;
     
     default:
@@ -107,123 +373,467 @@ void MEDTester::GraphAnalyser::analyze() const
         break;
     }
 
-    auto timeEnd = std::chrono::high_resolution_clock::now();
-    std::chrono::milliseconds executionTime = std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeStart);
-    if (mShowTime) {
-        *out << "execution time: " << executionTime.count() << " milliseconds\n";
+    if (context.profiler) {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - timeStart).count();
+        context.profiler->addGraphTime(graphNum, (uint64_t) nanos);
     }
-    
-    inputFile.close();
-    outputFile.close();
 }
 
+/* Graphs are split between the shards by their position in the input. */
+bool MEDTester::GraphAnalyser::isOwnedGraph(int position) const
+{
+    return (unsigned int) position % mShardsCount == mShardIndex;
+}
 
-void MEDTester::GraphAnalyser::onlyResultMode(std::istream& in, std::ostream& out) const
+/* Text input starts with the number of graphs (except in the streaming mode). Binary formats don't
+ * have it (-1 is returned), only an optional header which is skipped. */
+int MEDTester::GraphAnalyser::readHeader(MEDTester::InputReader& in) const
 {
-    int graphCount = getInt(in, "number of graphs");
-    for (int i = 1; i <= graphCount; ++i) {
-        int graphNum = getInt(in, "graph number, " + std::to_string(i) + ". graph");
-        MEDTester::CubicGraph graph(getAdjList(in, graphNum, true));
+    switch (mInputFormat)
+    {
+    case MEDTester::InputFormat::GRAPH6:
+        in.skipPrefix(">>graph6<<");
+        return -1;
 
-        if (mOnlyBridgeless) {
-            if (!graph.isBridgeless()) continue;
-        }
+    case MEDTester::InputFormat::MULTICODE:
+        in.skipPrefix(">>multi_code<<");
+        return -1;
 
-        #ifdef SAT
-            MEDTester::SatSolver solver(graph);
-            out << graphNum << ": " << (solver.isDecomposable() ? "true" : "false") << "\n";
-        #else
-            out << graphNum << ": " << (graph.isDecomposable() ? "true" : "false") << "\n";
-        #endif
+    default:
+        return mStreaming ? -1 : getInt(in, "number of graphs");
     }
 }
 
-void MEDTester::GraphAnalyser::notDecomposableMode(std::istream& in, std::ostream& out) const
+/* Reads the graph at the given position of the input, or only skips it if adjList is null. Returns
+ * false after the last graph - text input ends after the number of graphs from the header, binary
+ * formats and streamed text at the end of the input. Graphs in binary formats are numbered from 1 by their position. */
+bool MEDTester::GraphAnalyser::nextGraph(MEDTester::InputReader& in, int position, int graphCount, int& graphNum, MEDTester::FlatAdjList* adjList) const
 {
-    int graphCount = getInt(in, "number of graphs");
-    out << "Not decomposable graphs:\n";
-    for (int i = 1; i <= graphCount; ++i) {
-        int graphNum = getInt(in, "graph number, " + std::to_string(i) + ". graph");
-        MEDTester::CubicGraph graph(getAdjList(in, graphNum, true));
+    uint8_t c;
+    switch (mInputFormat)
+    {
+    case MEDTester::InputFormat::GRAPH6:
+        while (in.peekByte(c) && (c == '\n' || c == '\r')) in.nextByte(c);
+        if (!in.peekByte(c)) return false;
+        graphNum = position + 1;
+        if (adjList) getGraph6AdjList(in, graphNum, *adjList);
+        else skipGraph6(in);
+        return true;
 
-        if (mOnlyBridgeless) {
-            if (!graph.isBridgeless()) continue;
+    case MEDTester::InputFormat::MULTICODE:
+        if (!in.peekByte(c)) return false;
+        graphNum = position + 1;
+        if (adjList) getMulticodeAdjList(in, graphNum, *adjList);
+        else skipMulticode(in, graphNum);
+        return true;
+
+    default:
+        if (graphCount < 0 ? in.atEnd() : position >= graphCount) return false;
+        if (!in.nextInt(graphNum)) {
+            throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("missing graph number, " + std::to_string(position + 1) + ". graph"));
         }
+        if (adjList) getAdjList(in, graphNum, *adjList, true);
+        else skipAdjList(in, graphNum);
+        return true;
+    }
+}
 
-        #ifdef SAT
-            MEDTester::SatSolver solver(graph);
-            if (!solver.isDecomposable()) out << graphNum << "\n";
-        #else
-            if (!graph.isDecomposable()) out << graphNum << "\n";
-        #endif
+void MEDTester::GraphAnalyser::writeHeader(MEDTester::OutputWriter& out) const
+{
+    if (mOutputMode == MEDTester::OutputMode::NOT_DECOMPOSABLE) {
+        out.write("Not decomposable graphs:\n");
+    }
+    if (mOutputMode == MEDTester::OutputMode::BINARY_COLORING) {
+        uint8_t header[] = { MEDTester::ResultReader::VERSION, (uint8_t) (mWithAdjacency ? MEDTester::ResultReader::ADJACENCY_FLAG : 0), 0, 0 };
+        out.writeBytes(MEDTester::ResultReader::MAGIC, sizeof(MEDTester::ResultReader::MAGIC));
+        out.writeBytes(header, sizeof(header));
+    }
+}
+
+/* Threads of cryptominisat in the portfolio are split between the analysing threads. The count mode
+ * doesn't use the engines, so it has no portfolio. */
+void MEDTester::GraphAnalyser::initContext(WorkerContext& context, MEDTester::ResultCache* cache) const
+{
+    context.cache = cache;
+    std::atomic<bool>* interrupt = nullptr;
+    if (mPortfolioThreshold > 0 && mOutputMode != MEDTester::OutputMode::COUNT) {
+        unsigned int satThreadsCount = std::max(1u, std::thread::hardware_concurrency() / mThreadsCount);
+        context.portfolio = std::make_unique<MEDTester::Portfolio>(mEngine, mEncoding, mPortfolioThreshold, satThreadsCount);
+        interrupt = context.portfolio->getInterrupt();
     }
+    if (mUseSolverPool && mEngine == MEDTester::Engine::SAT_SOLVER) context.solverPool = std::make_unique<MEDTester::SatSolverPool>(mEncoding, interrupt);
+    if (!mProfileFilename.empty()) context.profiler = std::make_unique<MEDTester::Profiler>();
 }
 
-void MEDTester::GraphAnalyser::coloringMode(std::istream& in, std::ostream& out) const
+/* Checkpoint file is stored next to the output file, the output is needed to resume anyway. */
+std::string MEDTester::GraphAnalyser::getCheckpointFilename() const
 {
-    int graphCount = getInt(in, "number of graphs");
-    for (int i = 1; i <= graphCount; ++i) {
-        int graphNum = getInt(in, "graph number, " + std::to_string(i) + ". graph");
-        MEDTester::Matrix adjList = getAdjList(in, graphNum, true);
-        MEDTester::CubicGraph graph(adjList);
+    return mOutputFilename + CHECKPOINT_FILE_SUFFIX;
+}
 
-        if (mOnlyBridgeless) {
-            if (!graph.isBridgeless()) continue;
-        }
+/* Missing checkpoint file is not an error, the analysis just starts from the beginning. */
+void MEDTester::GraphAnalyser::loadCheckpoint(Checkpoint& checkpoint) const
+{
+    std::string filename = getCheckpointFilename();
+    std::ifstream file(filename);
+    if (!file.is_open()) return;
+
+    std::string header;
+    std::string key;
+    std::getline(file, header);
+    if (header != CHECKPOINT_FILE_HEADER) throw FileErrorException(INVALID_CHECKPOINT_MESSAGE(filename));
+
+    int keysCount = 0;
+    while (file >> key) {
+        if (key == "input-offset") file >> checkpoint.inputOffset;
+        else if (key == "position") file >> checkpoint.position;
+        else if (key == "graph-count") file >> checkpoint.graphCount;
+        else if (key == "output-offset") file >> checkpoint.outputOffset;
+        else break;
+        if (!file) break;
+        ++keysCount;
+    }
+    if (keysCount != 4 || !file.eof()) throw FileErrorException(INVALID_CHECKPOINT_MESSAGE(filename));
+
+    checkpoint.loaded = true;
+}
+
+/* Saves the progress if the checkpoint interval has passed since the last save (or if forced). The
+ * output is flushed first, so the saved length of the output is really in the file. The checkpoint
+ * is written to a temporary file and renamed, so a killed process leaves the previous one intact. */
+void MEDTester::GraphAnalyser::saveCheckpoint(Checkpoint& checkpoint, size_t inputOffset, int position, MEDTester::OutputWriter& out, bool force) const
+{
+    if (mCheckpointInterval == 0) return;
+    auto now = std::chrono::steady_clock::now();
+    if (!force && now < checkpoint.nextSave) return;
+    checkpoint.nextSave = now + std::chrono::seconds(mCheckpointInterval);
 
-        int width = (int) std::log10(graph.getVerticesCount()) + 1;
-
-        #ifdef SAT
-            MEDTester::SatSolver solver(graph);
-            out << "graph " << graphNum << ":\n";
-            if (solver.isDecomposable()) {
-                MEDTester::Decomposition coloring = solver.getDecomposition();
-                for (int i = 0; i < (int) adjList.size(); ++i) {
-                    out << std::setw(width) << i << ":";
-                    for (int j = 0; j < 3; ++j) {
-                        out << " " << adjList[i][j] << EDGE_TYPE_CHAR.at(coloring[i][j]);
-                    }
-                    out << "\n";
+    out.flush();
+    checkpoint.inputOffset = inputOffset;
+    checkpoint.position = position;
+    checkpoint.outputOffset = out.getOffset();
+
+    std::string filename = getCheckpointFilename();
+    std::string tempFilename = filename + ".tmp";
+    std::ofstream file(tempFilename, std::ofstream::out | std::ofstream::trunc);
+    file << CHECKPOINT_FILE_HEADER << "\n";
+    file << "input-offset " << checkpoint.inputOffset << "\n";
+    file << "position " << checkpoint.position << "\n";
+    file << "graph-count " << checkpoint.graphCount << "\n";
+    file << "output-offset " << checkpoint.outputOffset << "\n";
+    file.close();
+    if (!file) throw FileErrorException(CANNOT_OPEN_FILE_MESSAGE(tempFilename));
+
+    std::error_code error;
+    std::filesystem::rename(tempFilename, filename, error);
+    if (error) throw FileErrorException(CANNOT_OPEN_FILE_MESSAGE(filename));
+}
+
+void MEDTester::GraphAnalyser::writeStats(const StageStats& stats, std::ostream& out) const
+{
+    out << "graphs skipped (with a bridge): " << stats.skipped << "\n";
+    out << "graphs resolved by 3-edge-coloring: " << stats.coloring << "\n";
+    if (mUseCache) {
+        long lookups = stats.cached + stats.solver;
+        double hitRate = lookups > 0 ? 100.0 * stats.cached / lookups : 0.0;
+        out << "graphs resolved by cache: " << stats.cached << " (hit rate " << std::fixed << std::setprecision(1) << hitRate << "%)\n";
+    }
+    out << "graphs resolved by solver: " << stats.solver << "\n";
+    if (mPortfolioThreshold > 0) {
+        out << "graphs raced in portfolio: " << stats.raced << " (won by other searches: " << stats.won << ")\n";
+    }
+    if (mReduce && mEngine == MEDTester::Engine::SAT_SOLVER) {
+        double kernelShare = stats.reducedVertices > 0 ? 100.0 * stats.kernelVertices / stats.reducedVertices : 0.0;
+        out << "graphs reduced before solving: " << stats.reduced << " (kernels have " << std::fixed << std::setprecision(1) << kernelShare << "% of their vertices)\n";
+    }
+}
+
+/* The graph is solved already in the constructor of the solver, so its statistics are complete. */
+std::unique_ptr<MEDTester::SatSolver> MEDTester::GraphAnalyser::createSolver(WorkerContext& context, const MEDTester::CubicGraph& graph) const
+{
+    std::unique_ptr<MEDTester::SatSolver> solver;
+    if (context.solverPool) solver = std::make_unique<MEDTester::SatSolver>(graph, *context.solverPool);
+    else if (context.portfolio) solver = std::make_unique<MEDTester::SatSolver>(graph, mEncoding, 1, false, context.portfolio->getInterrupt());
+    else solver = std::make_unique<MEDTester::SatSolver>(graph, mEncoding);
+
+    if (context.profiler) {
+        const MEDTester::SatSolver::Stats& solverStats = solver->getStats();
+        context.profiler->addPhaseTime(MEDTester::Profiler::ENCODING, solverStats.theoryNanos);
+        context.profiler->addPhaseTime(MEDTester::Profiler::SOLVING, solverStats.solveNanos);
+        context.profiler->addSatStats(solverStats.conflicts, solverStats.decisions, solverStats.propagations);
+    }
+    return solver;
+}
+
+/* Graphs which are not reduced are left to createSolver, only the search for cuts is spent on them. */
+std::unique_ptr<MEDTester::Reducer> MEDTester::GraphAnalyser::createReducer(WorkerContext& context, const MEDTester::CubicGraph& graph, std::atomic<bool>* interrupt) const
+{
+    std::unique_ptr<MEDTester::Reducer> reducer = std::make_unique<MEDTester::Reducer>(graph, interrupt);
+    if (reducer->isReduced()) {
+        ++context.stats.reduced;
+        context.stats.reducedVertices += graph.getVerticesCount();
+        context.stats.kernelVertices += reducer->getKernelVerticesCount();
+    }
+
+    if (context.profiler) {
+        const MEDTester::SatSolver::Stats& reducerStats = reducer->getStats();
+        context.profiler->addPhaseTime(MEDTester::Profiler::ENCODING, reducerStats.theoryNanos);
+        context.profiler->addPhaseTime(MEDTester::Profiler::SOLVING, reducerStats.solveNanos);
+        context.profiler->addSatStats(reducerStats.conflicts, reducerStats.decisions, reducerStats.propagations);
+    }
+    return reducer;
+}
+
+/* The graph and its coloring are kept by the worker, so the next graph reuses their arrays. The
+ * coloring (and findDecomposition, which uses it) works on this graph only. */
+MEDTester::CubicGraph& MEDTester::GraphAnalyser::loadGraph(WorkerContext& context, const MEDTester::FlatAdjList& adjList) const
+{
+    context.graph.assign(adjList);
+    context.tait.reset();
+    return context.graph;
+}
+
+/* Graphs with a bridge are skipped (only with the bridgeless option). The check runs on the parsed
+ * adjacency list, so no CubicGraph is built for the skipped graphs. */
+bool MEDTester::GraphAnalyser::hasBridge(WorkerContext& context, const MEDTester::FlatAdjList& adjList) const
+{
+    if (!mOnlyBridgeless) return false;
+
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::BRIDGES);
+    if (MEDTester::CubicGraph::isBridgeless(adjList)) return false;
+    ++context.stats.skipped;
+    return true;
+}
+
+bool MEDTester::GraphAnalyser::isColorable(WorkerContext& context, MEDTester::TaitColoring& tait) const
+{
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::COLORING);
+    if (!tait.isColorable()) return false;
+    ++context.stats.coloring;
+    return true;
+}
+
+/* Decides the graph by the selected engine (the decomposition is found only if it is not null). With
+ * the portfolio, the search can be interrupted and the graph decided by another one. */
+bool MEDTester::GraphAnalyser::runEngine(WorkerContext& context, MEDTester::CubicGraph& graph, MEDTester::Decomposition* decomposition) const
+{
+    std::atomic<bool>* interrupt = context.portfolio ? context.portfolio->getInterrupt() : nullptr;
+    auto search = [&] (bool& decomposable, MEDTester::Decomposition* found) -> bool {
+        if (mEngine == MEDTester::Engine::BACKTRACKING) {
+            MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::SOLVING);
+            graph.setInterrupt(interrupt);
+            decomposable = graph.isDecomposable();
+            if (graph.isInterrupted()) return false;
+            if (decomposable && found) *found = graph.getDecomposition();
+        } else {
+            if (mReduce) {
+                std::unique_ptr<MEDTester::Reducer> reducer = createReducer(context, graph, interrupt);
+                if (reducer->isReduced()) {
+                    if (reducer->isInterrupted()) return false;
+                    decomposable = reducer->isDecomposable();
+                    if (decomposable && found) *found = reducer->getDecomposition();
+                    return true;
                 }
-            } else {
-                out << "false\n";
             }
-        #else
-            out << "graph " << graphNum << ":\n";
-            if (graph.isDecomposable()) {
-                MEDTester::Decomposition coloring = graph.getDecomposition();
-                for (int i = 0; i < graph.getVerticesCount(); ++i) {
-                    out << std::setw(width) << i << ":";
-                    for (int j = 0; j < 3; ++j) {
-                        out << " " << adjList[i][j] << EDGE_TYPE_CHAR.at(coloring[i][j]);
-                    }
-                    out << "\n";
-                }
-            } else {
-                out << "false\n";
+            std::unique_ptr<MEDTester::SatSolver> solver = createSolver(context, graph);
+            if (solver->isInterrupted()) return false;
+            decomposable = solver->isDecomposable();
+            if (decomposable && found) *found = solver->getDecomposition();
+        }
+        return true;
+    };
+
+    bool decomposable = false;
+    if (!context.portfolio) {
+        search(decomposable, decomposition);
+        return decomposable;
+    }
+
+    MEDTester::Portfolio::Result result = context.portfolio->solve(graph, search, decomposition);
+    if (result.raced) ++context.stats.raced;
+    if (result.won) ++context.stats.won;
+    return result.decomposable;
+}
+
+/* Decides a graph without a 3-edge-coloring by the selected engine, unless it is in the cache. */
+bool MEDTester::GraphAnalyser::isDecomposable(WorkerContext& context, MEDTester::CubicGraph& graph) const
+{
+    std::unique_ptr<MEDTester::CanonicalForm> form;
+    MEDTester::ResultCache::Result result;
+    if (findCachedResult(context, graph, form, result)) return result.decomposable;
+    ++context.stats.solver;
+
+    result.decomposable = runEngine(context, graph, nullptr);
+    insertCachedResult(context, graph, form, result);
+    return result.decomposable;
+}
+
+/* Graphs with a 3-edge-coloring get the matching and even cycles decomposition given by the
+ * coloring, other graphs are decomposed by the selected engine (or taken from the cache). */
+bool MEDTester::GraphAnalyser::findDecomposition(WorkerContext& context, MEDTester::CubicGraph& graph, MEDTester::Decomposition& decomposition) const
+{
+    bool decomposable;
+    MEDTester::TaitColoring& tait = context.tait;
+    std::unique_ptr<MEDTester::CanonicalForm> form;
+    MEDTester::ResultCache::Result result;
+    if (isColorable(context, tait)) {
+        decomposable = true;
+        tait.getDecomposition(decomposition);
+    } else if (findCachedResult(context, graph, form, result)) {
+        decomposable = result.decomposable;
+        decomposition = std::move(result.decomposition);
+    } else {
+        ++context.stats.solver;
+        decomposable = runEngine(context, graph, &decomposition);
+        result.decomposable = decomposable;
+        result.decomposition = decomposition;
+        insertCachedResult(context, graph, form, result);
+    }
+    return decomposable;
+}
+
+/* Graphs which are too symmetric to get a canonical form are neither looked up nor stored. */
+bool MEDTester::GraphAnalyser::findCachedResult(WorkerContext& context, const MEDTester::CubicGraph& graph, std::unique_ptr<MEDTester::CanonicalForm>& form, MEDTester::ResultCache::Result& result) const
+{
+    if (!context.cache) return false;
+
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::CACHE);
+    form = std::make_unique<MEDTester::CanonicalForm>(graph);
+    if (!form->isComputed()) return false;
+    if (!context.cache->find(graph, *form, result)) return false;
+
+    ++context.stats.cached;
+    return true;
+}
+
+void MEDTester::GraphAnalyser::insertCachedResult(WorkerContext& context, const MEDTester::CubicGraph& graph, const std::unique_ptr<MEDTester::CanonicalForm>& form, const MEDTester::ResultCache::Result& result) const
+{
+    if (!context.cache || !form || !form->isComputed()) return;
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::CACHE);
+    context.cache->insert(graph, *form, result);
+}
+
+
+void MEDTester::GraphAnalyser::onlyResultMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const
+{
+    if (hasBridge(context, adjList)) return;
+    MEDTester::CubicGraph& graph = loadGraph(context, adjList);
+
+    MEDTester::TaitColoring& tait = context.tait;
+    bool decomposable = isColorable(context, tait) || isDecomposable(context, graph);
+
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::OUTPUT);
+    out.writeInt(graphNum);
+    out.write(decomposable ? ": true\n" : ": false\n");
+}
+
+void MEDTester::GraphAnalyser::notDecomposableMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const
+{
+    if (hasBridge(context, adjList)) return;
+    MEDTester::CubicGraph& graph = loadGraph(context, adjList);
+
+    MEDTester::TaitColoring& tait = context.tait;
+    if (isColorable(context, tait)) return;
+    bool decomposable = isDecomposable(context, graph);
+
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::OUTPUT);
+    if (!decomposable) {
+        out.writeInt(graphNum);
+        out.write('\n');
+    }
+}
+
+void MEDTester::GraphAnalyser::coloringMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const
+{
+    if (hasBridge(context, adjList)) return;
+    MEDTester::CubicGraph& graph = loadGraph(context, adjList);
+
+    int width = (int) std::log10(graph.getVerticesCount()) + 1;
+
+    MEDTester::Decomposition& coloring = context.decomposition;
+    bool decomposable = findDecomposition(context, graph, coloring);
+
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::OUTPUT);
+    out.write("graph ");
+    out.writeInt(graphNum);
+    out.write(":\n");
+    if (decomposable) {
+        for (int i = 0; i < graph.getVerticesCount(); ++i) {
+            out.writeInt(i, width);
+            out.write(':');
+            for (int j = 0; j < 3; ++j) {
+                out.write(' ');
+                out.writeInt(adjList[3*i + j]);
+                out.writeEdgeType(coloring[i][j]);
             }
-        #endif
+            out.write('\n');
+        }
+    } else {
+        out.write("false\n");
     }
 }
 
-void MEDTester::GraphAnalyser::countMode(std::istream& in, std::ostream& out) const
+void MEDTester::GraphAnalyser::countMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const
 {
-    int graphCount = getInt(in, "number of graphs");
-    for (int i = 1; i <= graphCount; ++i) {
-        int graphNum = getInt(in, "graph number, " + std::to_string(i) + ". graph");
-        MEDTester::CubicGraph graph(getAdjList(in, graphNum, true));
+    if (hasBridge(context, adjList)) return;
+    MEDTester::CubicGraph& graph = loadGraph(context, adjList);
 
-        if (mOnlyBridgeless) {
-            if (!graph.isBridgeless()) continue;
+    /* Counting needs the full search, a 3-edge-coloring gives just one of the decompositions.
+     * Decompositions are counted by the dynamic programming (with any engine), enumerating them one
+     * by one would take time proportional to their number. */
+    std::unique_ptr<MEDTester::CanonicalForm> form;
+    MEDTester::ResultCache::Result result;
+    if (!findCachedResult(context, graph, form, result)) {
+        ++context.stats.solver;
+        {
+            MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::SOLVING);
+            MEDTester::DecompositionCounter counter(graph);
+            result.decompositionsCount = counter.getDecompositionsCount();
         }
+        insertCachedResult(context, graph, form, result);
+    }
+
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::OUTPUT);
+    out.writeInt(graphNum);
+    out.write(": ");
+    out.writeUnsigned(result.decompositionsCount);
+    out.write('\n');
+}
+
+/* Writes one record of the binary result format (see ResultReader). Edge types are packed in the
+ * canonical order, each edge is taken from its endpoint with the smaller number. */
+void MEDTester::GraphAnalyser::binaryColoringMode(WorkerContext& context, int graphNum, const MEDTester::FlatAdjList& adjList, MEDTester::OutputWriter& out) const
+{
+    if (hasBridge(context, adjList)) return;
+    MEDTester::CubicGraph& graph = loadGraph(context, adjList);
+
+    MEDTester::Decomposition& coloring = context.decomposition;
+    bool decomposable = findDecomposition(context, graph, coloring);
+
+    MEDTester::Profiler::Timer timer(context.profiler.get(), MEDTester::Profiler::OUTPUT);
+    out.writeUInt32((uint32_t) graphNum);
+    out.writeUInt32((uint32_t) graph.getVerticesCount());
+    out.write((char) (decomposable ? 1 : 0));
+    if (mWithAdjacency) {
+        for (int v : adjList) out.writeUInt32((uint32_t) v);
+    }
+    if (!decomposable) return;
 
-        #ifdef SAT
-            MEDTester::SatSolver solver(graph);
-            out << graphNum << ": " << solver.getDecompositionsCount() << "\n";
-        #else
-            out << graphNum << ": " << graph.getDecompositionsCount() << "\n";
-        #endif
+    uint32_t bits = 0;
+    int bitsCount = 0;
+    for (int u = 0; u < graph.getVerticesCount(); ++u) {
+        for (int j = 0; j < 3; ++j) {
+            if (adjList[3*u + j] < u) continue;
+            bits |= (uint32_t) coloring[u][j] << bitsCount;
+            bitsCount += 3;
+            if (bitsCount >= 8) {
+                out.write((char) (bits & 255));
+                bits >>= 8;
+                bitsCount -= 8;
+            }
+        }
     }
+    if (bitsCount > 0) out.write((char) bits);
 }
 
 
@@ -247,26 +857,55 @@ inline std::string MEDTester::GraphAnalyser::OUTPUT_MODE_NOT_IMPLEMENTED(const s
     return "Output mode '" + mode + "' is not implemented.";
 }
 
+inline std::string MEDTester::GraphAnalyser::CHECKPOINT_NEEDS_OUTPUT_FILE_MESSAGE()
+{
+    return "Checkpoints need an output file (the checkpoint is saved next to it).";
+}
+
+inline std::string MEDTester::GraphAnalyser::CANNOT_RESUME_MESSAGE(const std::string& filename)
+{
+    return "Cannot resume reading of the input '" + filename + "', only regular files can be resumed.";
+}
+
+inline std::string MEDTester::GraphAnalyser::INVALID_CHECKPOINT_MESSAGE(const std::string& filename)
+{
+    return "Invalid checkpoint file '" + filename + "'.";
+}
+
 
-int MEDTester::GraphAnalyser::getInt(std::istream& in, const std::string& what)
+int MEDTester::GraphAnalyser::getInt(MEDTester::InputReader& in, const std::string& what)
 {
     int x;
-    if (!(in >> x)) {
+    if (!in.nextInt(x)) {
         throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("missing " + what));
     }
     return x;
 }
 
-MEDTester::Matrix MEDTester::GraphAnalyser::getAdjList(std::istream& in, int graphNum, bool errorCheck = true)
+/* Reads adjacency list of one graph into the given (reused) array. Messages of errors are built
+ * only when an error occurs, so the common path is just scanning integers. Double edges are found
+ * by comparing with the previous entries of the same vertex. */
+void MEDTester::GraphAnalyser::getAdjList(MEDTester::InputReader& in, int graphNum, MEDTester::FlatAdjList& adjList, bool errorCheck = true)
 {
-    int numVertices = getInt(in, "number of vertices in graph " + std::to_string(graphNum));
+    int numVertices;
+    if (!in.nextInt(numVertices)) {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("missing number of vertices in graph " + std::to_string(graphNum)));
+    }
+    if (numVertices < 0) {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+            "negative number of vertices in graph " + std::to_string(graphNum)
+        ));
+    }
 
-    MEDTester::Matrix adjList(numVertices, MEDTester::MatrixLine(3, -1));
+    adjList.assign(3 * (size_t) numVertices, -1);
 
     for (int u = 0; u < numVertices; ++u) {
-        std::unordered_set<int> adjacentVertices;
+        int* line = adjList.data() + 3*u;
         for (int i = 0; i < 3; i++) {
-            int v = getInt(in, "adjacency list entry in graph " + std::to_string(graphNum));
+            int v;
+            if (!in.nextInt(v)) {
+                throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("missing adjacency list entry in graph " + std::to_string(graphNum)));
+            }
             
             if (errorCheck) {
                 if (v < 0 || v >= numVertices) {
@@ -279,22 +918,221 @@ MEDTester::Matrix MEDTester::GraphAnalyser::getAdjList(std::istream& in, int gra
                         "vertex " + std::to_string(v) + " has a loop, graph " + std::to_string(graphNum)
                     ));
                 }
-                if (adjacentVertices.count(v)) {
+                if ((i > 0 && line[0] == v) || (i > 1 && line[1] == v)) {
                     throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
                         "double edge from vertex " + std::to_string(u) + " to vertex " + std::to_string(v) + ", graph " + std::to_string(graphNum)
                     ));
                 }
-                if (adjList[v][0] != -1 && adjList[v][0] != u && adjList[v][1] != u && adjList[v][2] != u) {
+                const int* other = adjList.data() + 3*v;
+                if (other[0] != -1 && other[0] != u && other[1] != u && other[2] != u) {
                     throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
                         "trying to add edge from vertex " + std::to_string(u) + " to vertex " + std::to_string(v) + " while vertex " + std::to_string(v) + " has already 3 edges to other vertices, graph " + std::to_string(graphNum)
                     ));
                 }
             }
 
-            adjList[u][i] = v;
-            adjacentVertices.insert(v);
+            line[i] = v;
+        }
+    }
+
+    /* Vertices with greater number are not filled in when the edge is read, so the symmetry of the
+     * adjacency list has to be checked at the end. */
+    if (errorCheck) {
+        for (int u = 0; u < numVertices; ++u) {
+            for (int i = 0; i < 3; ++i) {
+                const int* other = adjList.data() + 3*adjList[3*u + i];
+                if (other[0] != u && other[1] != u && other[2] != u) {
+                    throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+                        "vertex " + std::to_string(u) + " is adjacent to vertex " + std::to_string(adjList[3*u + i]) + ", but not vice versa, graph " + std::to_string(graphNum)
+                    ));
+                }
+            }
+        }
+    }
+}
+
+/* Skips adjacency list of a graph analysed by another shard. Only the number of vertices is read,
+ * the entries are not converted nor checked. */
+void MEDTester::GraphAnalyser::skipAdjList(MEDTester::InputReader& in, int graphNum)
+{
+    int numVertices;
+    if (!in.nextInt(numVertices)) {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("missing number of vertices in graph " + std::to_string(graphNum)));
+    }
+    if (numVertices < 0) {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+            "negative number of vertices in graph " + std::to_string(graphNum)
+        ));
+    }
+
+    if (!in.skipInts(3 * (size_t) numVertices)) {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("missing adjacency list entry in graph " + std::to_string(graphNum)));
+    }
+}
+
+/* Reads one line in the graph6 format - the number of vertices (one byte, or 126 followed by 3 or
+ * 6 bytes for larger graphs) and the upper triangle of the adjacency matrix column by column, each
+ * byte holds 6 bits and all the bytes are offset by 63. The edges are put straight into the flat
+ * adjacency list, which is checked to be cubic at the end. */
+void MEDTester::GraphAnalyser::getGraph6AdjList(MEDTester::InputReader& in, int graphNum, MEDTester::FlatAdjList& adjList)
+{
+    auto nextValue = [&in, graphNum] () {
+        uint8_t c;
+        if (!in.nextByte(c)) {
+            throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("unexpected end of graph " + std::to_string(graphNum)));
+        }
+        if (c < 63 || c > 126) {
+            throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+                "invalid graph6 character '" + std::string(1, (char) c) + "' in graph " + std::to_string(graphNum)
+            ));
+        }
+        return (int) c - 63;
+    };
+
+    uint8_t c;
+    in.peekByte(c);
+    if (c == ':' || c == ';' || c == '&') {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+            "sparse6 and digraph6 formats are not supported, graph " + std::to_string(graphNum)
+        ));
+    }
+
+    long long numVertices = nextValue();
+    if (numVertices == 63) {
+        int bytesCount = 2;
+        numVertices = nextValue();
+        if (numVertices == 63) {
+            bytesCount = 6;
+            numVertices = 0;
+        }
+        for (int k = 0; k < bytesCount; ++k) numVertices = (numVertices << 6) | nextValue();
+    }
+    if (numVertices > INT_MAX / 3) {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("too many vertices in graph " + std::to_string(graphNum)));
+    }
+
+    int n = (int) numVertices;
+    adjList.assign(3 * (size_t) n, -1);
+
+    int i = 0;
+    int j = 1;
+    while (j < n) {
+        int value = nextValue();
+        for (int bit = 5; bit >= 0 && j < n; --bit) {
+            if ((value >> bit) & 1) addEdge(adjList, i, j, graphNum);
+            if (++i == j) {
+                i = 0;
+                ++j;
+            }
         }
     }
 
-    return adjList;
+    if (in.nextByte(c) && c != '\n' && c != '\r') {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("unexpected character after graph " + std::to_string(graphNum)));
+    }
+    checkDegrees(adjList, graphNum);
+}
+
+/* Skips one line of graph6 input without decoding it. */
+void MEDTester::GraphAnalyser::skipGraph6(MEDTester::InputReader& in)
+{
+    uint8_t c;
+    while (in.nextByte(c) && c != '\n') {}
+}
+
+/* Reads one graph in the multi_code format - the number of vertices followed by the neighbours of
+ * vertices 1, ..., n-1 (numbered from 1) with a greater number, each list terminated by 0. If the
+ * first byte is 0, the number of vertices and all the entries are 2-byte little-endian numbers. */
+void MEDTester::GraphAnalyser::getMulticodeAdjList(MEDTester::InputReader& in, int graphNum, MEDTester::FlatAdjList& adjList)
+{
+    bool wide = false;
+    auto nextEntry = [&in, &wide, graphNum] () {
+        uint8_t low, high = 0;
+        if (!in.nextByte(low) || (wide && !in.nextByte(high))) {
+            throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("missing adjacency list entry in graph " + std::to_string(graphNum)));
+        }
+        return (int) low | ((int) high << 8);
+    };
+
+    int n = nextEntry();
+    if (n == 0) {
+        wide = true;
+        n = nextEntry();
+    }
+    adjList.assign(3 * (size_t) n, -1);
+
+    for (int u = 1; u < n; ++u) {
+        for (int v = nextEntry(); v != 0; v = nextEntry()) {
+            if (v > n) {
+                throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+                    "vertex " + std::to_string(v - 1) + " out of range, graph " + std::to_string(graphNum)
+                ));
+            }
+            addEdge(adjList, u - 1, v - 1, graphNum);
+        }
+    }
+
+    checkDegrees(adjList, graphNum);
+}
+
+/* Skips one graph of multi_code input, only the terminators of the lists are counted. */
+void MEDTester::GraphAnalyser::skipMulticode(MEDTester::InputReader& in, int graphNum)
+{
+    bool wide = false;
+    auto nextEntry = [&in, &wide, graphNum] () {
+        uint8_t low, high = 0;
+        if (!in.nextByte(low) || (wide && !in.nextByte(high))) {
+            throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE("missing adjacency list entry in graph " + std::to_string(graphNum)));
+        }
+        return (int) low | ((int) high << 8);
+    };
+
+    int n = nextEntry();
+    if (n == 0) {
+        wide = true;
+        n = nextEntry();
+    }
+    for (int u = 1; u < n; ++u) {
+        while (nextEntry() != 0) {}
+    }
+}
+
+/* Adds an edge read from a binary format, the same errors as in the text format are reported. */
+void MEDTester::GraphAnalyser::addEdge(MEDTester::FlatAdjList& adjList, int u, int v, int graphNum)
+{
+    if (u == v) {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+            "vertex " + std::to_string(v) + " has a loop, graph " + std::to_string(graphNum)
+        ));
+    }
+
+    int* line = adjList.data() + 3*u;
+    int* other = adjList.data() + 3*v;
+    if (line[0] == v || line[1] == v || line[2] == v) {
+        throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+            "double edge from vertex " + std::to_string(u) + " to vertex " + std::to_string(v) + ", graph " + std::to_string(graphNum)
+        ));
+    }
+    for (int w : {u, v}) {
+        if (adjList[3*w + 2] != -1) {
+            int x = w == u ? v : u;
+            throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+                "trying to add edge from vertex " + std::to_string(x) + " to vertex " + std::to_string(w) + " while vertex " + std::to_string(w) + " has already 3 edges to other vertices, graph " + std::to_string(graphNum)
+            ));
+        }
+    }
+
+    *std::find(line, line + 3, -1) = v;
+    *std::find(other, other + 3, -1) = u;
+}
+
+void MEDTester::GraphAnalyser::checkDegrees(const MEDTester::FlatAdjList& adjList, int graphNum)
+{
+    for (size_t k = 0; k < adjList.size(); ++k) {
+        if (adjList[k] == -1) {
+            throw WrongInputException(WRONG_INPUT_FORMAT_MESSAGE(
+                "vertex " + std::to_string(k / 3) + " has less than 3 edges, graph " + std::to_string(graphNum)
+            ));
+        }
+    }
 }
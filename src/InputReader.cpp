@@ -0,0 +1,247 @@
+#include "InputReader.h"
+
+#include <string>
+#include <vector>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+const size_t MEDTester::InputReader::BUFFER_SIZE = 1 << 20;
+
+
+MEDTester::InputReader::InputReader()
+{
+    mFd = STDIN_FILENO;
+    mOwnsFd = false;
+    init();
+}
+
+MEDTester::InputReader::InputReader(const std::string& filename)
+{
+    mFd = open(filename.c_str(), O_RDONLY);
+    mOwnsFd = mFd != -1;
+    init();
+}
+
+MEDTester::InputReader::~InputReader()
+{
+    if (mMapped) munmap(mMappedData, mMappedLength);
+    if (mOwnsFd) close(mFd);
+}
+
+void MEDTester::InputReader::init()
+{
+    mMapped = false;
+    mEof = false;
+    mMappedData = nullptr;
+    mMappedLength = 0;
+    mPos = nullptr;
+    mEnd = nullptr;
+    mConsumedBefore = 0;
+
+    if (mFd == -1) {
+        mEof = true;
+        return;
+    }
+
+    /* Only non-empty regular files can be mapped, everything else is read through the buffer. */
+    struct stat info;
+    if (fstat(mFd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, mFd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, info.st_size, MADV_SEQUENTIAL);
+            mMapped = true;
+            mEof = true;
+            mMappedData = static_cast<char*>(data);
+            mMappedLength = info.st_size;
+            mPos = mMappedData;
+            mEnd = mMappedData + mMappedLength;
+            return;
+        }
+    }
+
+    mBuffer.resize(BUFFER_SIZE);
+    mPos = mEnd = mBuffer.data();
+}
+
+
+bool MEDTester::InputReader::isOpen() const
+{
+    return mFd != -1;
+}
+
+bool MEDTester::InputReader::isMapped() const
+{
+    return mMapped;
+}
+
+size_t MEDTester::InputReader::getOffset() const
+{
+    if (mMapped) return mPos - mMappedData;
+    return mConsumedBefore + (mPos - mBuffer.data());
+}
+
+
+/* Moves the reader to the given offset (from the beginning of the input). Regular files are
+ * mapped or can be repositioned, pipes and terminals can't. */
+bool MEDTester::InputReader::seek(size_t offset)
+{
+    if (mMapped) {
+        if (offset > mMappedLength) return false;
+        mPos = mMappedData + offset;
+        return true;
+    }
+
+    if (mFd == -1 || lseek(mFd, (off_t) offset, SEEK_SET) == (off_t) -1) return false;
+    mEof = false;
+    mConsumedBefore = offset;
+    mPos = mEnd = mBuffer.data();
+    return true;
+}
+
+
+/* Reads next integer in the same way as 'std::istream >> int' does - skips leading whitespace and
+ * fails on a missing number, a non-numeric character or a value out of the range of int. */
+bool MEDTester::InputReader::nextInt(int& x)
+{
+    if (!skipWhitespace()) return false;
+
+    bool negative = false;
+    if (*mPos == '-' || *mPos == '+') {
+        negative = *mPos == '-';
+        ++mPos;
+        if (mPos == mEnd && !refill()) return false;
+    }
+
+    if (*mPos < '0' || *mPos > '9') return false;
+
+    long long value = 0;
+    while (true) {
+        if (mPos == mEnd && !refill()) break;
+        unsigned int digit = (unsigned int) (*mPos - '0');
+        if (digit > 9) break;
+        value = value * 10 + digit;
+        if (value > (long long) INT_MAX + 1) return false;
+        ++mPos;
+    }
+
+    if (negative) value = -value;
+    if (value > INT_MAX || value < INT_MIN) return false;
+
+    x = (int) value;
+    return true;
+}
+
+/* Used to skip graphs which are not analysed, only the boundaries of tokens are found. */
+bool MEDTester::InputReader::skipInts(size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (!skipWhitespace()) return false;
+        while (true) {
+            while (mPos != mEnd) {
+                char c = *mPos;
+                if (c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f') break;
+                ++mPos;
+            }
+            if (mPos != mEnd || !refill()) break;
+        }
+    }
+    return true;
+}
+
+bool MEDTester::InputReader::atEnd()
+{
+    return !skipWhitespace();
+}
+
+
+bool MEDTester::InputReader::nextByte(uint8_t& x)
+{
+    if (mPos == mEnd && !refill()) return false;
+    x = (uint8_t) *mPos++;
+    return true;
+}
+
+bool MEDTester::InputReader::peekByte(uint8_t& x)
+{
+    if (mPos == mEnd && !refill()) return false;
+    x = (uint8_t) *mPos;
+    return true;
+}
+
+bool MEDTester::InputReader::skipPrefix(const std::string& prefix)
+{
+    if (!ensure(prefix.size()) || memcmp(mPos, prefix.data(), prefix.size()) != 0) return false;
+    mPos += prefix.size();
+    return true;
+}
+
+
+bool MEDTester::InputReader::refill()
+{
+    if (mEof) return false;
+
+    mConsumedBefore += mPos - mBuffer.data();
+
+    ssize_t count;
+    do {
+        count = read(mFd, mBuffer.data(), mBuffer.size());
+    } while (count == -1 && errno == EINTR);
+
+    if (count <= 0) {
+        mEof = true;
+        mPos = mEnd = mBuffer.data();
+        return false;
+    }
+
+    mPos = mBuffer.data();
+    mEnd = mPos + count;
+    return true;
+}
+
+/* Makes at least count bytes available at the current position (if the input has them). Unlike
+ * refill, the unconsumed bytes are kept - they are moved to the beginning of the buffer. */
+bool MEDTester::InputReader::ensure(size_t count)
+{
+    if ((size_t) (mEnd - mPos) >= count) return true;
+    if (mMapped || mEof || count > mBuffer.size()) return false;
+
+    size_t remaining = mEnd - mPos;
+    mConsumedBefore += mPos - mBuffer.data();
+    memmove(mBuffer.data(), mPos, remaining);
+    mPos = mBuffer.data();
+    mEnd = mPos + remaining;
+
+    while (remaining < count) {
+        ssize_t read_count;
+        do {
+            read_count = read(mFd, mBuffer.data() + remaining, mBuffer.size() - remaining);
+        } while (read_count == -1 && errno == EINTR);
+
+        if (read_count <= 0) {
+            mEof = true;
+            return false;
+        }
+        remaining += read_count;
+        mEnd += read_count;
+    }
+    return true;
+}
+
+bool MEDTester::InputReader::skipWhitespace()
+{
+    while (true) {
+        while (mPos != mEnd) {
+            char c = *mPos;
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t' && c != '\v' && c != '\f') return true;
+            ++mPos;
+        }
+        if (!refill()) return false;
+    }
+}
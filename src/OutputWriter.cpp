@@ -0,0 +1,142 @@
+#include "OutputWriter.h"
+
+#include "typedefs.h"
+
+#include <string>
+#include <ostream>
+#include <cstring>
+#include <cstdint>
+
+
+const size_t MEDTester::OutputWriter::BUFFER_SIZE = 1 << 16;
+
+/* Indexed by the value of EdgeType, 'H' is the double-star leaf edge. */
+const char MEDTester::OutputWriter::EDGE_TYPE_CHAR[] = { '-', 'M', 'C', 'H', 'S' };
+
+
+MEDTester::OutputWriter::OutputWriter()
+{
+    mSink = nullptr;
+    mOffset = 0;
+    mBuffer.reserve(BUFFER_SIZE);
+}
+
+MEDTester::OutputWriter::OutputWriter(std::ostream& sink, size_t offset)
+{
+    mSink = &sink;
+    mOffset = offset;
+    mBuffer.reserve(BUFFER_SIZE);
+}
+
+MEDTester::OutputWriter::~OutputWriter()
+{
+    if (mSink && !mBuffer.empty()) mSink->write(mBuffer.data(), mBuffer.size());
+}
+
+
+void MEDTester::OutputWriter::write(char c)
+{
+    mBuffer.push_back(c);
+    checkSize();
+}
+
+void MEDTester::OutputWriter::write(const char* text)
+{
+    mBuffer.append(text, strlen(text));
+    checkSize();
+}
+
+void MEDTester::OutputWriter::write(const std::string& text)
+{
+    mBuffer.append(text);
+    checkSize();
+}
+
+void MEDTester::OutputWriter::writeInt(long long x)
+{
+    writeInt(x, 0);
+}
+
+void MEDTester::OutputWriter::writeInt(long long x, int width)
+{
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    uint64_t magnitude = x < 0 ? 0 - (uint64_t) x : (uint64_t) x;
+    size_t length = formatUnsigned(magnitude, end);
+    if (x < 0) digits[sizeof(digits) - ++length] = '-';
+
+    if ((size_t) width > length) mBuffer.append(width - length, ' ');
+    mBuffer.append(end - length, length);
+    checkSize();
+}
+
+void MEDTester::OutputWriter::writeUnsigned(uint64_t x)
+{
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    size_t length = formatUnsigned(x, end);
+    mBuffer.append(end - length, length);
+    checkSize();
+}
+
+void MEDTester::OutputWriter::writeEdgeType(MEDTester::EdgeType type)
+{
+    mBuffer.push_back(EDGE_TYPE_CHAR[(int) type]);
+}
+
+void MEDTester::OutputWriter::writeBytes(const void* data, size_t size)
+{
+    mBuffer.append(static_cast<const char*>(data), size);
+    checkSize();
+}
+
+void MEDTester::OutputWriter::writeUInt32(uint32_t x)
+{
+    char bytes[4] = { (char) (x & 255), (char) ((x >> 8) & 255), (char) ((x >> 16) & 255), (char) (x >> 24) };
+    mBuffer.append(bytes, 4);
+    checkSize();
+}
+
+
+size_t MEDTester::OutputWriter::getOffset() const
+{
+    return mOffset + mBuffer.size();
+}
+
+
+void MEDTester::OutputWriter::flush()
+{
+    if (!mSink) return;
+    if (!mBuffer.empty()) mSink->write(mBuffer.data(), mBuffer.size());
+    mOffset += mBuffer.size();
+    mBuffer.clear();
+    mSink->flush();
+}
+
+std::string MEDTester::OutputWriter::takeBuffer()
+{
+    std::string buffer(mBuffer);
+    mBuffer.clear();
+    return buffer;
+}
+
+
+/* The buffer may grow over its size within a single write, it is written out right after. */
+void MEDTester::OutputWriter::checkSize()
+{
+    if (!mSink || mBuffer.size() < BUFFER_SIZE) return;
+    mSink->write(mBuffer.data(), mBuffer.size());
+    mOffset += mBuffer.size();
+    mBuffer.clear();
+}
+
+/* Writes the digits right-aligned before the end of the array and returns their number. */
+size_t MEDTester::OutputWriter::formatUnsigned(uint64_t x, char* end)
+{
+    char* pos = end;
+    do {
+        *--pos = (char) ('0' + x % 10);
+        x /= 10;
+    } while (x != 0);
+    return end - pos;
+}
@@ -1,6 +1,9 @@
 #include "Parser.h"
 
 #include "OutputMode.h"
+#include "Engine.h"
+#include "InputFormat.h"
+#include "Encoding.h"
 
 #include <string>
 #include <cstring>
@@ -8,6 +11,7 @@
 #include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 
 
 const MEDTester::Parser::OptionInfo<std::string> MEDTester::Parser::INPUT_FILENAME_OPTION_INFO
@@ -55,6 +59,141 @@ const MEDTester::Parser::OptionInfo<bool> MEDTester::Parser::SHOW_TIME_OPTION_IN
     false
 };
 
+const MEDTester::Parser::OptionInfo<unsigned int> MEDTester::Parser::THREADS_COUNT_OPTION_INFO
+{
+    "threads count",
+    "Specifies number of worker threads analysing graphs in parallel (0 means one thread per available core). Results are written in the same order as in the input. Default is 1.",
+    { "--threads", "-j" },
+    true,
+    1
+};
+
+const MEDTester::Parser::OptionInfo<bool> MEDTester::Parser::SOLVER_POOL_OPTION_INFO
+{
+    "solver pool",
+    "Reuses one SAT solver for all graphs with the same number of vertices instead of building a new solver for each graph (clauses of each graph are switched on by an activation literal). Speeds up the analysis of many small graphs.",
+    { "--solver-pool", "-p" },
+    false,
+    false
+};
+
+const MEDTester::Parser::OptionInfo<bool> MEDTester::Parser::SHOW_STATS_OPTION_INFO
+{
+    "show stats",
+    "Adds numbers of graphs resolved by each stage of the analysis (filtered out for a bridge, decided by a 3-edge-coloring, answered from the cache, decided by the solver) at the end of the output.",
+    { "--stats", "-s" },
+    false,
+    false
+};
+
+const MEDTester::Parser::OptionInfo<MEDTester::Engine> MEDTester::Parser::ENGINE_OPTION_INFO
+{
+    "engine",
+    "Specifies the search deciding graphs which have no 3-edge-coloring.",
+    { "--engine", "-e" },
+    true,
+    MEDTester::Engine::SAT_SOLVER
+};
+
+const MEDTester::Parser::OptionInfo<bool> MEDTester::Parser::USE_CACHE_OPTION_INFO
+{
+    "use cache",
+    "Remembers results of analysed graphs by their canonical labelling, so isomorphic copies of a graph repeated in the input are answered without solving them again. Number of graphs answered from the cache and the hit rate are shown by the stats option.",
+    { "--dedup", "-d" },
+    false,
+    false
+};
+
+const MEDTester::Parser::OptionInfo<std::pair<unsigned int, unsigned int>> MEDTester::Parser::SHARD_OPTION_INFO
+{
+    "shard",
+    "Analyses only the graphs assigned to the shard given as 'i/N' - the graphs at positions i, i+N, i+2N, ... of the input (counted from 0). Other graphs are skipped without being parsed, so N processes can share one input file. Results contain the graph numbers, so the outputs of the shards can be merged.",
+    { "--shard", "-k" },
+    true,
+    { 0, 1 }
+};
+
+const MEDTester::Parser::OptionInfo<MEDTester::InputFormat> MEDTester::Parser::INPUT_FORMAT_OPTION_INFO
+{
+    "input format",
+    "Specifies the format of the input. Binary formats are read until the end of the input (they don't start with the number of graphs) and the graphs are numbered by their position, so the output of a generator can be piped directly to the program.",
+    { "--format", "-f" },
+    true,
+    MEDTester::InputFormat::TEXT
+};
+
+const MEDTester::Parser::OptionInfo<bool> MEDTester::Parser::STREAMING_OPTION_INFO
+{
+    "streaming",
+    "Reads graphs until the end of the input and writes the result of each graph as soon as it is known. The text input doesn't start with the number of graphs in this mode (the binary formats never do), so the output of a running generator can be piped to the program. The memory usage doesn't depend on the length of the input.",
+    { "--stream", "-l" },
+    false,
+    false
+};
+
+const MEDTester::Parser::OptionInfo<bool> MEDTester::Parser::WITH_ADJACENCY_OPTION_INFO
+{
+    "with adjacency",
+    "Includes the adjacency list of each graph in the binary coloring mode, so the edge types can be read without the input file.",
+    { "--adjacency", "-a" },
+    false,
+    false
+};
+
+const MEDTester::Parser::OptionInfo<unsigned int> MEDTester::Parser::CHECKPOINT_INTERVAL_OPTION_INFO
+{
+    "checkpoint interval",
+    "Saves the progress of the analysis every given number of seconds to the file '<output>.checkpoint' next to the output file - the position in the input, the number of graphs processed and the length of the output written so far. Needs the output file option.",
+    { "--checkpoint", "-c" },
+    true,
+    0
+};
+
+const MEDTester::Parser::OptionInfo<bool> MEDTester::Parser::RESUME_OPTION_INFO
+{
+    "resume",
+    "Continues an interrupted analysis from its last checkpoint - the output file is truncated to the saved length and reading of the input file starts at the saved position. If there is no checkpoint, the analysis starts from the beginning. Checkpoints are saved as with the checkpoint option (every 10 seconds if it is omitted). Stats cover only the graphs analysed after resuming.",
+    { "--resume", "-r" },
+    false,
+    false
+};
+
+const MEDTester::Parser::OptionInfo<std::string> MEDTester::Parser::PROFILE_FILENAME_OPTION_INFO
+{
+    "profile filename",
+    "Measures the time spent in each phase of the analysis (reading, bridge test, 3-edge-coloring, cache, SAT encoding, solving and writing) and of each graph, and writes a JSON summary to the given file at the end - total and maximal times with latency histograms, numbers of the slowest graphs, the peak memory and the numbers of conflicts, decisions and propagations of the SAT solver.",
+    { "--profile", "-u" },
+    true,
+    std::string()
+};
+
+const MEDTester::Parser::OptionInfo<unsigned int> MEDTester::Parser::PORTFOLIO_THRESHOLD_OPTION_INFO
+{
+    "portfolio threshold",
+    "Races more searches on graphs which are not decided by the selected engine within the given number of milliseconds - the other engine and a SAT solver with the other encoding and the opposite default polarity (using more threads with the cryptominisat library). The first answer is used and the other searches are stopped. The count mode doesn't use it. 0 (default) turns it off.",
+    { "--portfolio", "-x" },
+    true,
+    0
+};
+
+const MEDTester::Parser::OptionInfo<MEDTester::Encoding> MEDTester::Parser::ENCODING_OPTION_INFO
+{
+    "encoding",
+    "Specifies how the decomposition is encoded for the SAT solver (used by the sat engine and by the SAT solvers of the portfolio).",
+    { "--encoding", "-n" },
+    true,
+    MEDTester::Encoding::COMPACT
+};
+
+const MEDTester::Parser::OptionInfo<bool> MEDTester::Parser::REDUCE_OPTION_INFO
+{
+    "reduce",
+    "Cuts graphs along bridges, 2-edge-cuts, cyclic 3- and 4-edge-cuts, triangles and squares before solving (used by the sat engine). Each piece is solved once for the states of the edges leaving it and replaced by their table, then only the rest of the graph is given to the SAT solver. Pieces always use the compact encoding. The count mode doesn't use it. Graphs without such cuts are solved as usual. Numbers of reduced graphs and the size of their rests are shown by the stats option.",
+    { "--reduce", "-g" },
+    false,
+    false
+};
+
 
 const MEDTester::Parser::ModeInfo<MEDTester::OutputMode> MEDTester::Parser::ONLY_RESULT_MODE_INFO
 {
@@ -88,12 +227,96 @@ const MEDTester::Parser::ModeInfo<MEDTester::OutputMode> MEDTester::Parser::COUN
     MEDTester::OutputMode::COUNT
 };
 
+const MEDTester::Parser::ModeInfo<MEDTester::OutputMode> MEDTester::Parser::BINARY_COLORING_MODE_INFO
+{
+    "binary coloring",
+    "Writes the decompositions in a compact binary format instead of the text of the coloring mode - the graph number, the number of vertices, whether the graph is decomposable and the types of all edges packed by 3 bits (see the binary result format below). Stats and time are written to the standard error output in this mode.",
+    { "binarycoloring", "bc" },
+    MEDTester::OutputMode::BINARY_COLORING
+};
+
 const std::vector<MEDTester::Parser::ModeInfo<MEDTester::OutputMode>> MEDTester::Parser::AVAILABLE_OUTPUTMODES
 {
     MEDTester::Parser::ONLY_RESULT_MODE_INFO,
     MEDTester::Parser::NOT_DECOMPOSABLE_MODE_INFO,
     MEDTester::Parser::COLORING_MODE_INFO,
-    MEDTester::Parser::COUNT_MODE_INFO
+    MEDTester::Parser::COUNT_MODE_INFO,
+    MEDTester::Parser::BINARY_COLORING_MODE_INFO
+};
+
+const MEDTester::Parser::ModeInfo<MEDTester::Engine> MEDTester::Parser::SAT_ENGINE_INFO
+{
+    "sat",
+    "Encodes the decomposition as a SAT problem and solves it by the SAT solver (cryptominisat or the built-in one).",
+    { "sat", "s" },
+    MEDTester::Engine::SAT_SOLVER
+};
+
+const MEDTester::Parser::ModeInfo<MEDTester::Engine> MEDTester::Parser::BACKTRACKING_ENGINE_INFO
+{
+    "backtracking",
+    "Assigns edge types vertex by vertex in DFS order and backtracks as soon as an odd cycle or adjacent double-star leaves appear.",
+    { "backtracking", "b" },
+    MEDTester::Engine::BACKTRACKING
+};
+
+const std::vector<MEDTester::Parser::ModeInfo<MEDTester::Engine>> MEDTester::Parser::AVAILABLE_ENGINES
+{
+    MEDTester::Parser::SAT_ENGINE_INFO,
+    MEDTester::Parser::BACKTRACKING_ENGINE_INFO
+};
+
+const MEDTester::Parser::ModeInfo<MEDTester::InputFormat> MEDTester::Parser::TEXT_FORMAT_INFO
+{
+    "text",
+    "Number of graphs followed by the adjacency lists of the graphs (see the input format below).",
+    { "text", "t" },
+    MEDTester::InputFormat::TEXT
+};
+
+const MEDTester::Parser::ModeInfo<MEDTester::InputFormat> MEDTester::Parser::GRAPH6_FORMAT_INFO
+{
+    "graph6",
+    "One graph per line in the graph6 format (as written by nauty's geng), the optional '>>graph6<<' header is skipped.",
+    { "graph6", "g6" },
+    MEDTester::InputFormat::GRAPH6
+};
+
+const MEDTester::Parser::ModeInfo<MEDTester::InputFormat> MEDTester::Parser::MULTICODE_FORMAT_INFO
+{
+    "multicode",
+    "Binary multi_code format (as written by snarkhunter or genreg), the optional '>>multi_code<<' header is skipped.",
+    { "multicode", "mc" },
+    MEDTester::InputFormat::MULTICODE
+};
+
+const std::vector<MEDTester::Parser::ModeInfo<MEDTester::InputFormat>> MEDTester::Parser::AVAILABLE_INPUT_FORMATS
+{
+    MEDTester::Parser::TEXT_FORMAT_INFO,
+    MEDTester::Parser::GRAPH6_FORMAT_INFO,
+    MEDTester::Parser::MULTICODE_FORMAT_INFO
+};
+
+const MEDTester::Parser::ModeInfo<MEDTester::Encoding> MEDTester::Parser::ONE_HOT_ENCODING_INFO
+{
+    "onehot",
+    "Five variables per edge, one for each edge type with the cycle edges split by their parity, and clauses between adjacent edges.",
+    { "onehot", "o" },
+    MEDTester::Encoding::ONE_HOT
+};
+
+const MEDTester::Parser::ModeInfo<MEDTester::Encoding> MEDTester::Parser::COMPACT_ENCODING_INFO
+{
+    "compact",
+    "Four variables per edge - cycle, double-star center and double-star leaf edge (matching edge has none of them) and the parity of a cycle edge, and clauses describing the allowed types of edges at each vertex. It has about two thirds of the clauses and four fifths of the variables of the onehot encoding.",
+    { "compact", "c" },
+    MEDTester::Encoding::COMPACT
+};
+
+const std::vector<MEDTester::Parser::ModeInfo<MEDTester::Encoding>> MEDTester::Parser::AVAILABLE_ENCODINGS
+{
+    MEDTester::Parser::ONE_HOT_ENCODING_INFO,
+    MEDTester::Parser::COMPACT_ENCODING_INFO
 };
 
 const std::string MEDTester::Parser::HELP_SPECIFIER = "help";
@@ -111,6 +334,22 @@ MEDTester::Parser::Parser(char** begin, char** end)
     mOutputMode = OUTPUT_MODE_OPTION_INFO.defaultValue;
     mShowTime = SHOW_TIME_OPTION_INFO.defaultValue;
     mOnlyBridgeless = ONLY_BRIDGELESS_OPTION_INFO.defaultValue;
+    mThreadsCount = THREADS_COUNT_OPTION_INFO.defaultValue;
+    mUseSolverPool = SOLVER_POOL_OPTION_INFO.defaultValue;
+    mShowStats = SHOW_STATS_OPTION_INFO.defaultValue;
+    mEngine = ENGINE_OPTION_INFO.defaultValue;
+    mUseCache = USE_CACHE_OPTION_INFO.defaultValue;
+    mShardIndex = SHARD_OPTION_INFO.defaultValue.first;
+    mShardsCount = SHARD_OPTION_INFO.defaultValue.second;
+    mInputFormat = INPUT_FORMAT_OPTION_INFO.defaultValue;
+    mStreaming = STREAMING_OPTION_INFO.defaultValue;
+    mWithAdjacency = WITH_ADJACENCY_OPTION_INFO.defaultValue;
+    mCheckpointInterval = CHECKPOINT_INTERVAL_OPTION_INFO.defaultValue;
+    mResume = RESUME_OPTION_INFO.defaultValue;
+    mProfileFilename = PROFILE_FILENAME_OPTION_INFO.defaultValue;
+    mPortfolioThreshold = PORTFOLIO_THRESHOLD_OPTION_INFO.defaultValue;
+    mEncoding = ENCODING_OPTION_INFO.defaultValue;
+    mReduce = REDUCE_OPTION_INFO.defaultValue;
 }
 
 MEDTester::Parser::~Parser() {}
@@ -151,6 +390,86 @@ bool MEDTester::Parser::getShowTime() const
     return mShowTime;
 }
 
+unsigned int MEDTester::Parser::getThreadsCount() const
+{
+    return mThreadsCount;
+}
+
+bool MEDTester::Parser::getUseSolverPool() const
+{
+    return mUseSolverPool;
+}
+
+bool MEDTester::Parser::getShowStats() const
+{
+    return mShowStats;
+}
+
+MEDTester::Engine MEDTester::Parser::getEngine() const
+{
+    return mEngine;
+}
+
+bool MEDTester::Parser::getUseCache() const
+{
+    return mUseCache;
+}
+
+unsigned int MEDTester::Parser::getShardIndex() const
+{
+    return mShardIndex;
+}
+
+unsigned int MEDTester::Parser::getShardsCount() const
+{
+    return mShardsCount;
+}
+
+MEDTester::InputFormat MEDTester::Parser::getInputFormat() const
+{
+    return mInputFormat;
+}
+
+bool MEDTester::Parser::getStreaming() const
+{
+    return mStreaming;
+}
+
+bool MEDTester::Parser::getWithAdjacency() const
+{
+    return mWithAdjacency;
+}
+
+unsigned int MEDTester::Parser::getCheckpointInterval() const
+{
+    return mCheckpointInterval;
+}
+
+bool MEDTester::Parser::getResume() const
+{
+    return mResume;
+}
+
+std::string MEDTester::Parser::getProfileFilename() const
+{
+    return mProfileFilename;
+}
+
+unsigned int MEDTester::Parser::getPortfolioThreshold() const
+{
+    return mPortfolioThreshold;
+}
+
+MEDTester::Encoding MEDTester::Parser::getEncoding() const
+{
+    return mEncoding;
+}
+
+bool MEDTester::Parser::getReduce() const
+{
+    return mReduce;
+}
+
 
 void MEDTester::Parser::setArgumentRange(char** begin, char** end)
 {
@@ -186,6 +505,82 @@ void MEDTester::Parser::setShowTime(bool showTime)
     mShowTime = showTime;
 }
 
+void MEDTester::Parser::setThreadsCount(unsigned int threadsCount)
+{
+    mThreadsCount = threadsCount;
+}
+
+void MEDTester::Parser::setUseSolverPool(bool useSolverPool)
+{
+    mUseSolverPool = useSolverPool;
+}
+
+void MEDTester::Parser::setShowStats(bool showStats)
+{
+    mShowStats = showStats;
+}
+
+void MEDTester::Parser::setEngine(MEDTester::Engine engine)
+{
+    mEngine = engine;
+}
+
+void MEDTester::Parser::setUseCache(bool useCache)
+{
+    mUseCache = useCache;
+}
+
+void MEDTester::Parser::setShard(unsigned int shardIndex, unsigned int shardsCount)
+{
+    mShardIndex = shardIndex;
+    mShardsCount = shardsCount;
+}
+
+void MEDTester::Parser::setInputFormat(MEDTester::InputFormat inputFormat)
+{
+    mInputFormat = inputFormat;
+}
+
+void MEDTester::Parser::setStreaming(bool streaming)
+{
+    mStreaming = streaming;
+}
+
+void MEDTester::Parser::setWithAdjacency(bool withAdjacency)
+{
+    mWithAdjacency = withAdjacency;
+}
+
+void MEDTester::Parser::setCheckpointInterval(unsigned int checkpointInterval)
+{
+    mCheckpointInterval = checkpointInterval;
+}
+
+void MEDTester::Parser::setResume(bool resume)
+{
+    mResume = resume;
+}
+
+void MEDTester::Parser::setProfileFilename(const std::string& filename)
+{
+    mProfileFilename = filename;
+}
+
+void MEDTester::Parser::setPortfolioThreshold(unsigned int portfolioThreshold)
+{
+    mPortfolioThreshold = portfolioThreshold;
+}
+
+void MEDTester::Parser::setEncoding(MEDTester::Encoding encoding)
+{
+    mEncoding = encoding;
+}
+
+void MEDTester::Parser::setReduce(bool reduce)
+{
+    mReduce = reduce;
+}
+
 
 void MEDTester::Parser::checkSyntax(char** begin, char** end)
 {
@@ -226,6 +621,66 @@ void MEDTester::Parser::checkSyntax(char** begin, char** end)
             optionName = SHOW_TIME_OPTION_INFO.name;
             optionHasArg = SHOW_TIME_OPTION_INFO.hasArg;
         }
+        else if (std::find(THREADS_COUNT_OPTION_INFO.specifiers.begin(), THREADS_COUNT_OPTION_INFO.specifiers.end(), *it) != THREADS_COUNT_OPTION_INFO.specifiers.end()) {
+            optionName = THREADS_COUNT_OPTION_INFO.name;
+            optionHasArg = THREADS_COUNT_OPTION_INFO.hasArg;
+        }
+        else if (std::find(SOLVER_POOL_OPTION_INFO.specifiers.begin(), SOLVER_POOL_OPTION_INFO.specifiers.end(), *it) != SOLVER_POOL_OPTION_INFO.specifiers.end()) {
+            optionName = SOLVER_POOL_OPTION_INFO.name;
+            optionHasArg = SOLVER_POOL_OPTION_INFO.hasArg;
+        }
+        else if (std::find(SHOW_STATS_OPTION_INFO.specifiers.begin(), SHOW_STATS_OPTION_INFO.specifiers.end(), *it) != SHOW_STATS_OPTION_INFO.specifiers.end()) {
+            optionName = SHOW_STATS_OPTION_INFO.name;
+            optionHasArg = SHOW_STATS_OPTION_INFO.hasArg;
+        }
+        else if (std::find(ENGINE_OPTION_INFO.specifiers.begin(), ENGINE_OPTION_INFO.specifiers.end(), *it) != ENGINE_OPTION_INFO.specifiers.end()) {
+            optionName = ENGINE_OPTION_INFO.name;
+            optionHasArg = ENGINE_OPTION_INFO.hasArg;
+        }
+        else if (std::find(USE_CACHE_OPTION_INFO.specifiers.begin(), USE_CACHE_OPTION_INFO.specifiers.end(), *it) != USE_CACHE_OPTION_INFO.specifiers.end()) {
+            optionName = USE_CACHE_OPTION_INFO.name;
+            optionHasArg = USE_CACHE_OPTION_INFO.hasArg;
+        }
+        else if (std::find(SHARD_OPTION_INFO.specifiers.begin(), SHARD_OPTION_INFO.specifiers.end(), *it) != SHARD_OPTION_INFO.specifiers.end()) {
+            optionName = SHARD_OPTION_INFO.name;
+            optionHasArg = SHARD_OPTION_INFO.hasArg;
+        }
+        else if (std::find(INPUT_FORMAT_OPTION_INFO.specifiers.begin(), INPUT_FORMAT_OPTION_INFO.specifiers.end(), *it) != INPUT_FORMAT_OPTION_INFO.specifiers.end()) {
+            optionName = INPUT_FORMAT_OPTION_INFO.name;
+            optionHasArg = INPUT_FORMAT_OPTION_INFO.hasArg;
+        }
+        else if (std::find(STREAMING_OPTION_INFO.specifiers.begin(), STREAMING_OPTION_INFO.specifiers.end(), *it) != STREAMING_OPTION_INFO.specifiers.end()) {
+            optionName = STREAMING_OPTION_INFO.name;
+            optionHasArg = STREAMING_OPTION_INFO.hasArg;
+        }
+        else if (std::find(WITH_ADJACENCY_OPTION_INFO.specifiers.begin(), WITH_ADJACENCY_OPTION_INFO.specifiers.end(), *it) != WITH_ADJACENCY_OPTION_INFO.specifiers.end()) {
+            optionName = WITH_ADJACENCY_OPTION_INFO.name;
+            optionHasArg = WITH_ADJACENCY_OPTION_INFO.hasArg;
+        }
+        else if (std::find(CHECKPOINT_INTERVAL_OPTION_INFO.specifiers.begin(), CHECKPOINT_INTERVAL_OPTION_INFO.specifiers.end(), *it) != CHECKPOINT_INTERVAL_OPTION_INFO.specifiers.end()) {
+            optionName = CHECKPOINT_INTERVAL_OPTION_INFO.name;
+            optionHasArg = CHECKPOINT_INTERVAL_OPTION_INFO.hasArg;
+        }
+        else if (std::find(RESUME_OPTION_INFO.specifiers.begin(), RESUME_OPTION_INFO.specifiers.end(), *it) != RESUME_OPTION_INFO.specifiers.end()) {
+            optionName = RESUME_OPTION_INFO.name;
+            optionHasArg = RESUME_OPTION_INFO.hasArg;
+        }
+        else if (std::find(PROFILE_FILENAME_OPTION_INFO.specifiers.begin(), PROFILE_FILENAME_OPTION_INFO.specifiers.end(), *it) != PROFILE_FILENAME_OPTION_INFO.specifiers.end()) {
+            optionName = PROFILE_FILENAME_OPTION_INFO.name;
+            optionHasArg = PROFILE_FILENAME_OPTION_INFO.hasArg;
+        }
+        else if (std::find(PORTFOLIO_THRESHOLD_OPTION_INFO.specifiers.begin(), PORTFOLIO_THRESHOLD_OPTION_INFO.specifiers.end(), *it) != PORTFOLIO_THRESHOLD_OPTION_INFO.specifiers.end()) {
+            optionName = PORTFOLIO_THRESHOLD_OPTION_INFO.name;
+            optionHasArg = PORTFOLIO_THRESHOLD_OPTION_INFO.hasArg;
+        }
+        else if (std::find(ENCODING_OPTION_INFO.specifiers.begin(), ENCODING_OPTION_INFO.specifiers.end(), *it) != ENCODING_OPTION_INFO.specifiers.end()) {
+            optionName = ENCODING_OPTION_INFO.name;
+            optionHasArg = ENCODING_OPTION_INFO.hasArg;
+        }
+        else if (std::find(REDUCE_OPTION_INFO.specifiers.begin(), REDUCE_OPTION_INFO.specifiers.end(), *it) != REDUCE_OPTION_INFO.specifiers.end()) {
+            optionName = REDUCE_OPTION_INFO.name;
+            optionHasArg = REDUCE_OPTION_INFO.hasArg;
+        }
         else throw InvalidSyntaxException(UNKNOWN_OPTION_MESSAGE(*it));
 
         if (mentionedOptions.count(optionName))
@@ -359,38 +814,339 @@ bool MEDTester::Parser::parseShowTime()
     return false;
 }
 
-void MEDTester::Parser::parseAll()
+bool MEDTester::Parser::parseThreadsCount()
 {
-    parseInputFilename();
-    parseOutputFilename();
-    parseOutputMode();
-    parseOnlyBridgeless();
-    parseShowTime();
-}
+    std::string specifier;
+    for (std::string s : THREADS_COUNT_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            specifier = s;
+            break;
+        }
+    }
+
+    if (specifier.empty())
+        return false;
 
+    std::string value = getOptionArgument(specifier);
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.length() > 6)
+        throw InvalidSyntaxException(INVALID_NUMBER_MESSAGE(THREADS_COUNT_OPTION_INFO.name, value));
 
-void MEDTester::Parser::printHelpMessage()
+    mThreadsCount = (unsigned int) std::stoi(value);
+    if (mThreadsCount == 0)
+        mThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+    return true;
+}
+
+bool MEDTester::Parser::parseUseSolverPool()
 {
-    size_t TAB = 3;
-    size_t WIDTH = 100;
+    for (std::string s : SOLVER_POOL_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            mUseSolverPool = true;
+            return true;
+        }
+    }
 
-    std::cout << "MED is a program for testing cubic graphs - whether they are MED-decomposable or not.\n\n";
+    return false;
+}
 
-    std::cout << "USAGE\n";
-    std::cout << formatText(
-        "./med" +
-        joinToString(INPUT_FILENAME_OPTION_INFO.specifiers, " [", " <path>]", " | ") +
-        joinToString(OUTPUT_FILENAME_OPTION_INFO.specifiers, " [", " <path>]", " | ") +
-        joinToString(OUTPUT_MODE_OPTION_INFO.specifiers, " [", " <mode_name>]", " | ") +
-        joinToString(ONLY_BRIDGELESS_OPTION_INFO.specifiers, " [", "]", " | ") +
-        joinToString(SHOW_TIME_OPTION_INFO.specifiers, " [", "]", " | "),
-        1*TAB,
-        WIDTH
-    ) << "\n";
+bool MEDTester::Parser::parseShowStats()
+{
+    for (std::string s : SHOW_STATS_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            mShowStats = true;
+            return true;
+        }
+    }
 
-    std::cout << "OPTIONS\n";
-    std::cout << formatText(
-        joinToString(INPUT_FILENAME_OPTION_INFO.specifiers, "", "", ", "),
+    return false;
+}
+
+bool MEDTester::Parser::parseEngine()
+{
+    std::string specifier;
+    for (std::string s : ENGINE_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            specifier = s;
+            break;
+        }
+    }
+
+    if (specifier.empty())
+        return false;
+
+    std::string engineSpecifier = getOptionArgument(specifier);
+    for (ModeInfo<MEDTester::Engine> engine : AVAILABLE_ENGINES) {
+        if (std::find(engine.specifiers.begin(), engine.specifiers.end(), engineSpecifier) != engine.specifiers.end()) {
+            mEngine = engine.value;
+            return true;
+        }
+    }
+
+    throw InvalidSyntaxException(UNKNOWN_ENGINE_MESSAGE(engineSpecifier));
+}
+
+bool MEDTester::Parser::parseUseCache()
+{
+    for (std::string s : USE_CACHE_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            mUseCache = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MEDTester::Parser::parseShard()
+{
+    std::string specifier;
+    for (std::string s : SHARD_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            specifier = s;
+            break;
+        }
+    }
+
+    if (specifier.empty())
+        return false;
+
+    std::string value = getOptionArgument(specifier);
+    size_t slash = value.find('/');
+    if (slash == std::string::npos)
+        throw InvalidSyntaxException(INVALID_SHARD_MESSAGE(value));
+
+    std::string index = value.substr(0, slash);
+    std::string count = value.substr(slash + 1);
+    for (const std::string& number : {index, count}) {
+        if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos || number.length() > 9)
+            throw InvalidSyntaxException(INVALID_SHARD_MESSAGE(value));
+    }
+
+    mShardIndex = (unsigned int) std::stoi(index);
+    mShardsCount = (unsigned int) std::stoi(count);
+    if (mShardsCount == 0 || mShardIndex >= mShardsCount)
+        throw InvalidSyntaxException(INVALID_SHARD_MESSAGE(value));
+    return true;
+}
+
+bool MEDTester::Parser::parseInputFormat()
+{
+    std::string specifier;
+    for (std::string s : INPUT_FORMAT_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            specifier = s;
+            break;
+        }
+    }
+
+    if (specifier.empty())
+        return false;
+
+    std::string formatSpecifier = getOptionArgument(specifier);
+    for (ModeInfo<MEDTester::InputFormat> format : AVAILABLE_INPUT_FORMATS) {
+        if (std::find(format.specifiers.begin(), format.specifiers.end(), formatSpecifier) != format.specifiers.end()) {
+            mInputFormat = format.value;
+            return true;
+        }
+    }
+
+    throw InvalidSyntaxException(UNKNOWN_INPUT_FORMAT_MESSAGE(formatSpecifier));
+}
+
+bool MEDTester::Parser::parseStreaming()
+{
+    for (std::string s : STREAMING_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            mStreaming = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MEDTester::Parser::parseWithAdjacency()
+{
+    for (std::string s : WITH_ADJACENCY_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            mWithAdjacency = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MEDTester::Parser::parseCheckpointInterval()
+{
+    std::string specifier;
+    for (std::string s : CHECKPOINT_INTERVAL_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            specifier = s;
+            break;
+        }
+    }
+
+    if (specifier.empty())
+        return false;
+
+    std::string value = getOptionArgument(specifier);
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.length() > 6)
+        throw InvalidSyntaxException(INVALID_NUMBER_MESSAGE(CHECKPOINT_INTERVAL_OPTION_INFO.name, value));
+
+    mCheckpointInterval = (unsigned int) std::stoi(value);
+    return true;
+}
+
+bool MEDTester::Parser::parseResume()
+{
+    for (std::string s : RESUME_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            mResume = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MEDTester::Parser::parseProfileFilename()
+{
+    std::string specifier;
+    for (std::string s : PROFILE_FILENAME_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            specifier = s;
+            break;
+        }
+    }
+
+    if (specifier.empty())
+        return false;
+
+    std::string filename = getOptionArgument(specifier);
+    mProfileFilename = filename;
+    return true;
+}
+
+bool MEDTester::Parser::parsePortfolioThreshold()
+{
+    std::string specifier;
+    for (std::string s : PORTFOLIO_THRESHOLD_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            specifier = s;
+            break;
+        }
+    }
+
+    if (specifier.empty())
+        return false;
+
+    std::string value = getOptionArgument(specifier);
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.length() > 9)
+        throw InvalidSyntaxException(INVALID_NUMBER_MESSAGE(PORTFOLIO_THRESHOLD_OPTION_INFO.name, value));
+
+    mPortfolioThreshold = (unsigned int) std::stoi(value);
+    return true;
+}
+
+bool MEDTester::Parser::parseEncoding()
+{
+    std::string specifier;
+    for (std::string s : ENCODING_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            specifier = s;
+            break;
+        }
+    }
+
+    if (specifier.empty())
+        return false;
+
+    std::string encodingSpecifier = getOptionArgument(specifier);
+    for (ModeInfo<MEDTester::Encoding> encoding : AVAILABLE_ENCODINGS) {
+        if (std::find(encoding.specifiers.begin(), encoding.specifiers.end(), encodingSpecifier) != encoding.specifiers.end()) {
+            mEncoding = encoding.value;
+            return true;
+        }
+    }
+
+    throw InvalidSyntaxException(UNKNOWN_ENCODING_MESSAGE(encodingSpecifier));
+}
+
+bool MEDTester::Parser::parseReduce()
+{
+    for (std::string s : REDUCE_OPTION_INFO.specifiers) {
+        if (optionExists(s)) {
+            mReduce = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void MEDTester::Parser::parseAll()
+{
+    parseInputFilename();
+    parseOutputFilename();
+    parseOutputMode();
+    parseOnlyBridgeless();
+    parseShowTime();
+    parseThreadsCount();
+    parseUseSolverPool();
+    parseShowStats();
+    parseEngine();
+    parseUseCache();
+    parseShard();
+    parseInputFormat();
+    parseStreaming();
+    parseWithAdjacency();
+    parseCheckpointInterval();
+    parseResume();
+    parseProfileFilename();
+    parsePortfolioThreshold();
+    parseEncoding();
+    parseReduce();
+}
+
+
+void MEDTester::Parser::printHelpMessage()
+{
+    size_t TAB = 3;
+    size_t WIDTH = 100;
+
+    std::cout << "MED is a program for testing cubic graphs - whether they are MED-decomposable or not.\n\n";
+
+    std::cout << "USAGE\n";
+    std::cout << formatText(
+        "./med" +
+        joinToString(INPUT_FILENAME_OPTION_INFO.specifiers, " [", " <path>]", " | ") +
+        joinToString(OUTPUT_FILENAME_OPTION_INFO.specifiers, " [", " <path>]", " | ") +
+        joinToString(OUTPUT_MODE_OPTION_INFO.specifiers, " [", " <mode_name>]", " | ") +
+        joinToString(ONLY_BRIDGELESS_OPTION_INFO.specifiers, " [", "]", " | ") +
+        joinToString(SHOW_TIME_OPTION_INFO.specifiers, " [", "]", " | ") +
+        joinToString(THREADS_COUNT_OPTION_INFO.specifiers, " [", " <count>]", " | ") +
+        joinToString(SOLVER_POOL_OPTION_INFO.specifiers, " [", "]", " | ") +
+        joinToString(SHOW_STATS_OPTION_INFO.specifiers, " [", "]", " | ") +
+        joinToString(ENGINE_OPTION_INFO.specifiers, " [", " <engine_name>]", " | ") +
+        joinToString(USE_CACHE_OPTION_INFO.specifiers, " [", "]", " | ") +
+        joinToString(SHARD_OPTION_INFO.specifiers, " [", " <i/N>]", " | ") +
+        joinToString(INPUT_FORMAT_OPTION_INFO.specifiers, " [", " <format_name>]", " | ") +
+        joinToString(STREAMING_OPTION_INFO.specifiers, " [", "]", " | ") +
+        joinToString(WITH_ADJACENCY_OPTION_INFO.specifiers, " [", "]", " | ") +
+        joinToString(CHECKPOINT_INTERVAL_OPTION_INFO.specifiers, " [", " <seconds>]", " | ") +
+        joinToString(RESUME_OPTION_INFO.specifiers, " [", "]", " | ") +
+        joinToString(PROFILE_FILENAME_OPTION_INFO.specifiers, " [", " <path>]", " | ") +
+        joinToString(PORTFOLIO_THRESHOLD_OPTION_INFO.specifiers, " [", " <milliseconds>]", " | ") +
+        joinToString(ENCODING_OPTION_INFO.specifiers, " [", " <encoding_name>]", " | ") +
+        joinToString(REDUCE_OPTION_INFO.specifiers, " [", "]", " | "),
+        1*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << "OPTIONS\n";
+    std::cout << formatText(
+        joinToString(INPUT_FILENAME_OPTION_INFO.specifiers, "", "", ", "),
         1*TAB,
         WIDTH
     );
@@ -450,9 +1206,192 @@ void MEDTester::Parser::printHelpMessage()
         WIDTH
     ) << "\n";
 
+    std::cout << formatText(
+        joinToString(THREADS_COUNT_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        THREADS_COUNT_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(SOLVER_POOL_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        SOLVER_POOL_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(SHOW_STATS_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        SHOW_STATS_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(ENGINE_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        ENGINE_OPTION_INFO.description +
+        " Use with one of the following engine names (default is 'sat' engine):",
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    for (ModeInfo engine : AVAILABLE_ENGINES) {
+        std::cout << formatText(joinToString(engine.specifiers, "", "", " / "), 2*TAB, WIDTH);
+        std::cout << formatText(engine.description, 3*TAB, WIDTH) << "\n";
+    }
+
+    std::cout << formatText(
+        joinToString(USE_CACHE_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        USE_CACHE_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(SHARD_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        SHARD_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(INPUT_FORMAT_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        INPUT_FORMAT_OPTION_INFO.description +
+        " Use with one of the following format names (default is 'text' format):",
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    for (ModeInfo format : AVAILABLE_INPUT_FORMATS) {
+        std::cout << formatText(joinToString(format.specifiers, "", "", " / "), 2*TAB, WIDTH);
+        std::cout << formatText(format.description, 3*TAB, WIDTH) << "\n";
+    }
+
+    std::cout << formatText(
+        joinToString(STREAMING_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        STREAMING_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(WITH_ADJACENCY_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        WITH_ADJACENCY_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(CHECKPOINT_INTERVAL_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        CHECKPOINT_INTERVAL_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(RESUME_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        RESUME_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(PROFILE_FILENAME_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        PROFILE_FILENAME_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(PORTFOLIO_THRESHOLD_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        PORTFOLIO_THRESHOLD_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    std::cout << formatText(
+        joinToString(ENCODING_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        ENCODING_OPTION_INFO.description +
+        " Use with one of the following encoding names (default is 'compact' encoding):",
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
+    for (ModeInfo encoding : AVAILABLE_ENCODINGS) {
+        std::cout << formatText(joinToString(encoding.specifiers, "", "", " / "), 2*TAB, WIDTH);
+        std::cout << formatText(encoding.description, 3*TAB, WIDTH) << "\n";
+    }
+
+    std::cout << formatText(
+        joinToString(REDUCE_OPTION_INFO.specifiers, "", "", ", "),
+        1*TAB,
+        WIDTH
+    );
+    std::cout << formatText(
+        REDUCE_OPTION_INFO.description,
+        2*TAB,
+        WIDTH
+    ) << "\n";
+
     std::cout << "INPUT FORMAT\n";
     std::cout << formatText(std::string() +
-        "The input should consist of only integers separated by any whitespace. The first integer is a total number of tested graphs. " +
+        "The input should consist of only integers separated by any whitespace. The first integer is a total number of tested graphs (it is omitted in the streaming mode). " +
         "Then follows that number of graph descriptions. A graph description starts with the number of graph (can be actually any number), " +
         "followed by the number of vertices. Vertices are by default numbered from 0 to n-1, where n is the number of vertices. Next n " +
         "\"lines\" represents the adjency list - each \"line\" consists of three integers. If k-th line has integers a, b and c, then " +
@@ -463,6 +1402,13 @@ void MEDTester::Parser::printHelpMessage()
     ) << "\n";
 
     std::cout << "\t2\n\t1\n\t4\n\t1 2 3\n\t0 2 3\n\t0 1 3\n\t0 1 2\n\t2\n\t10\n\t1 2 3\n\t0 4 5\n\t0 6 7\n\t0 8 9\n\t1 7 8\n\t1 6 9\n\t2 5 8\n\t2 4 9\n\t3 4 6\n\t3 5 7\n";
+
+    std::cout << "\nBINARY RESULT FORMAT\n";
+    std::cout << formatText(std::string() +
+        "The binary coloring mode writes an 8-byte header ('MEDR', version 1, flags and 2 reserved bytes, flag 1 means the adjacency lists are included) followed by one record per graph. All numbers are 32-bit little-endian. A record holds the graph number, the number of vertices n, one byte which is 1 if the graph is MED-decomposable, then the adjacency list (3n numbers, only with the adjacency option) and, for decomposable graphs, the types of the 3n/2 edges packed by 3 bits from the lowest bit of each byte (1 = matching edge, 2 = cycle edge, 3 = double-star point edge, 4 = double-star center edge). Edges are ordered by their smaller endpoint and by the position of the other endpoint in its adjacency line.",
+        1*TAB,
+        WIDTH
+    );
 }
 
 
@@ -488,6 +1434,31 @@ inline std::string MEDTester::Parser::UNKNOWN_OUTPUT_MODE_MESSAGE(const std::str
     return "Uknown output mode '" + mode + "'. Use '" + HELP_SPECIFIER + "' for command description.";
 }
 
+inline std::string MEDTester::Parser::UNKNOWN_ENGINE_MESSAGE(const std::string& engine)
+{
+    return "Uknown engine '" + engine + "'. Use '" + HELP_SPECIFIER + "' for command description.";
+}
+
+inline std::string MEDTester::Parser::INVALID_NUMBER_MESSAGE(const std::string& option, const std::string& value)
+{
+    return "Invalid argument '" + value + "' of option '" + option + "', expected a non-negative integer.";
+}
+
+inline std::string MEDTester::Parser::INVALID_SHARD_MESSAGE(const std::string& value)
+{
+    return "Invalid argument '" + value + "' of option '" + SHARD_OPTION_INFO.name + "', expected 'i/N' with 0 <= i < N.";
+}
+
+inline std::string MEDTester::Parser::UNKNOWN_INPUT_FORMAT_MESSAGE(const std::string& format)
+{
+    return "Uknown input format '" + format + "'. Use '" + HELP_SPECIFIER + "' for command description.";
+}
+
+inline std::string MEDTester::Parser::UNKNOWN_ENCODING_MESSAGE(const std::string& encoding)
+{
+    return "Uknown encoding '" + encoding + "'. Use '" + HELP_SPECIFIER + "' for command description.";
+}
+
 std::string MEDTester::Parser::formatText(const std::string& text, size_t indent, size_t width)
 {
     size_t curPos = 0;
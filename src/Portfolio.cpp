@@ -0,0 +1,166 @@
+#include "Portfolio.h"
+
+#include "typedefs.h"
+#include "Engine.h"
+#include "Encoding.h"
+#include "CubicGraph.h"
+#include "SatSolver.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <cstdint>
+
+
+const int MEDTester::Portfolio::CONTESTANTS_COUNT = 2;
+const std::chrono::milliseconds MEDTester::Portfolio::INTERRUPT_REPEAT(1);
+
+
+MEDTester::Portfolio::Portfolio(MEDTester::Engine engine, MEDTester::Encoding encoding, unsigned int thresholdMillis, unsigned int satThreadsCount)
+{
+    mEngine = engine;
+    mEncoding = encoding;
+    mThreshold = std::chrono::milliseconds(thresholdMillis);
+    mSatThreadsCount = satThreadsCount > 0 ? satThreadsCount : 1;
+    mGeneration = 0;
+    mGraph = nullptr;
+    mWithDecomposition = false;
+    mSearchRunning = false;
+    mRunningCount = 0;
+    mStartedCount = 0;
+    mDecided = true;
+    mDecomposable = false;
+    mStopping = false;
+    mInterrupt = false;
+
+    for (int c = 0; c < CONTESTANTS_COUNT; ++c) {
+        mContestants.emplace_back(&MEDTester::Portfolio::runContestants, this, c);
+    }
+}
+
+MEDTester::Portfolio::~Portfolio()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+        mInterrupt = true;
+    }
+    mCondition.notify_all();
+    for (std::thread& contestant : mContestants) contestant.join();
+}
+
+
+std::atomic<bool>* MEDTester::Portfolio::getInterrupt()
+{
+    return &mInterrupt;
+}
+
+/* The graph has to stay valid until all contestants working on it stop, so the function waits for
+ * them. Cryptominisat clears the interrupt flag when a solve call starts, a contestant could miss it
+ * if it was set just before, so it is set again until all of them return. */
+MEDTester::Portfolio::Result MEDTester::Portfolio::solve(const MEDTester::CubicGraph& graph, const MEDTester::Portfolio::Search& search, MEDTester::Decomposition* decomposition)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mGeneration;
+        mGraph = &graph;
+        mWithDecomposition = decomposition != nullptr;
+        mDeadline = std::chrono::steady_clock::now() + mThreshold;
+        mSearchRunning = true;
+        mStartedCount = 0;
+        mDecided = false;
+        mInterrupt = false;
+    }
+    mCondition.notify_all();
+
+    bool decomposable = false;
+    bool finished = search(decomposable, decomposition);
+
+    Result result;
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSearchRunning = false;
+    if (finished && !mDecided) {
+        mDecided = true;
+        mInterrupt = true;
+        result.decomposable = decomposable;
+    } else {
+        result.won = true;
+        result.decomposable = mDecomposable;
+        if (decomposition && mDecomposable) *decomposition = std::move(mDecomposition);
+    }
+    mCondition.notify_all();
+
+    while (mRunningCount > 0) {
+        mInterrupt = true;
+        mCondition.wait_for(lock, INTERRUPT_REPEAT);
+    }
+    result.raced = mStartedCount > 0;
+    return result;
+}
+
+
+/* Loop of one contestant thread - it waits for a new graph, then for its deadline, and if the graph
+ * is still not decided, it searches too. The winner keeps the interrupt flag set until the search
+ * of the selected engine returns (for the same reason as in solve). */
+void MEDTester::Portfolio::runContestants(int contestant)
+{
+    uint64_t generation = 0;
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mCondition.wait(lock, [&] { return mStopping || (!mDecided && mGeneration != generation); });
+        if (mStopping) return;
+        generation = mGeneration;
+        if (mCondition.wait_until(lock, mDeadline, [&] { return mStopping || mDecided || mGeneration != generation; })) continue;
+
+        const MEDTester::CubicGraph& graph = *mGraph;
+        bool withDecomposition = mWithDecomposition;
+        ++mRunningCount;
+        ++mStartedCount;
+        lock.unlock();
+
+        bool decomposable = false;
+        MEDTester::Decomposition decomposition;
+        bool finished = runContestant(contestant, graph, withDecomposition, decomposable, decomposition);
+
+        lock.lock();
+        --mRunningCount;
+        if (finished && !mDecided && mGeneration == generation) {
+            mDecided = true;
+            mDecomposable = decomposable;
+            mDecomposition = std::move(decomposition);
+            mInterrupt = true;
+            while (mSearchRunning && mGeneration == generation && !mStopping) {
+                mInterrupt = true;
+                mCondition.wait_for(lock, INTERRUPT_REPEAT);
+            }
+        }
+        mCondition.notify_all();
+    }
+}
+
+/* The first contestant uses the other engine (a SAT solver if the selected engine is backtracking),
+ * the second one a SAT solver with the other encoding and the opposite polarity. The backtracking search of the selected
+ * engine changes the graph meanwhile, so only its adjacency list is read. */
+bool MEDTester::Portfolio::runContestant(int contestant, const MEDTester::CubicGraph& graph, bool withDecomposition, bool& decomposable, MEDTester::Decomposition& decomposition)
+{
+    MEDTester::CubicGraph copy(graph.getAdjList());
+    if (contestant == 0 && mEngine == MEDTester::Engine::SAT_SOLVER) {
+        copy.setInterrupt(&mInterrupt);
+        decomposable = copy.isDecomposable();
+        if (copy.isInterrupted()) return false;
+        if (decomposable && withDecomposition) decomposition = copy.getDecomposition();
+        return true;
+    }
+
+    MEDTester::Encoding encoding = mEncoding;
+    if (contestant == 1) encoding = mEncoding == MEDTester::Encoding::COMPACT ? MEDTester::Encoding::ONE_HOT : MEDTester::Encoding::COMPACT;
+    MEDTester::SatSolver solver(copy, encoding, mSatThreadsCount, contestant == 1, &mInterrupt);
+    if (solver.isInterrupted()) return false;
+    decomposable = solver.isDecomposable();
+    if (decomposable && withDecomposition) decomposition = solver.getDecomposition();
+    return true;
+}
@@ -0,0 +1,174 @@
+#include "Profiler.h"
+
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+
+const size_t MEDTester::Profiler::BUCKETS_COUNT = 48;
+const size_t MEDTester::Profiler::SLOWEST_GRAPHS_COUNT = 10;
+const char* const MEDTester::Profiler::PHASE_NAMES[PHASES_COUNT] = {
+    "parsing", "bridges", "coloring", "cache", "encoding", "solving", "output"
+};
+
+
+MEDTester::Profiler::Timer::Timer(MEDTester::Profiler* profiler, MEDTester::Profiler::Phase phase)
+{
+    mProfiler = profiler;
+    mPhase = phase;
+    if (mProfiler) mStart = std::chrono::steady_clock::now();
+}
+
+MEDTester::Profiler::Timer::~Timer()
+{
+    if (!mProfiler) return;
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart).count();
+    mProfiler->addPhaseTime(mPhase, (uint64_t) nanos);
+}
+
+
+MEDTester::Profiler::Profiler()
+{
+    mConflicts = 0;
+    mDecisions = 0;
+    mPropagations = 0;
+}
+
+MEDTester::Profiler::~Profiler() {}
+
+
+void MEDTester::Profiler::addPhaseTime(MEDTester::Profiler::Phase phase, uint64_t nanos)
+{
+    mPhases[phase].add(nanos);
+}
+
+void MEDTester::Profiler::addGraphTime(int graphNum, uint64_t nanos)
+{
+    mGraphs.add(nanos);
+
+    std::pair<uint64_t, int> entry(nanos, graphNum);
+    if (mSlowestGraphs.size() < SLOWEST_GRAPHS_COUNT) {
+        mSlowestGraphs.push_back(entry);
+        std::push_heap(mSlowestGraphs.begin(), mSlowestGraphs.end(), std::greater<std::pair<uint64_t, int>>());
+    } else if (entry > mSlowestGraphs.front()) {
+        std::pop_heap(mSlowestGraphs.begin(), mSlowestGraphs.end(), std::greater<std::pair<uint64_t, int>>());
+        mSlowestGraphs.back() = entry;
+        std::push_heap(mSlowestGraphs.begin(), mSlowestGraphs.end(), std::greater<std::pair<uint64_t, int>>());
+    }
+}
+
+void MEDTester::Profiler::addSatStats(uint64_t conflicts, uint64_t decisions, uint64_t propagations)
+{
+    mConflicts += conflicts;
+    mDecisions += decisions;
+    mPropagations += propagations;
+}
+
+void MEDTester::Profiler::merge(const MEDTester::Profiler& other)
+{
+    for (int p = 0; p < PHASES_COUNT; ++p) mPhases[p].merge(other.mPhases[p]);
+    mGraphs.merge(other.mGraphs);
+
+    /* Graph times of the other profiler are already in the histogram, only the slowest ones are added. */
+    for (const std::pair<uint64_t, int>& entry : other.mSlowestGraphs) {
+        if (mSlowestGraphs.size() < SLOWEST_GRAPHS_COUNT) {
+            mSlowestGraphs.push_back(entry);
+            std::push_heap(mSlowestGraphs.begin(), mSlowestGraphs.end(), std::greater<std::pair<uint64_t, int>>());
+        } else if (entry > mSlowestGraphs.front()) {
+            std::pop_heap(mSlowestGraphs.begin(), mSlowestGraphs.end(), std::greater<std::pair<uint64_t, int>>());
+            mSlowestGraphs.back() = entry;
+            std::push_heap(mSlowestGraphs.begin(), mSlowestGraphs.end(), std::greater<std::pair<uint64_t, int>>());
+        }
+    }
+
+    addSatStats(other.mConflicts, other.mDecisions, other.mPropagations);
+}
+
+
+void MEDTester::Profiler::writeJson(std::ostream& out, uint64_t totalNanos) const
+{
+    out << "{\n";
+    out << "  \"total_ns\": " << totalNanos << ",\n";
+    out << "  \"peak_rss_kb\": " << getPeakMemory() << ",\n";
+    out << "  \"graphs\": ";
+    mGraphs.writeJson(out);
+    out << ",\n  \"phases\": {";
+    for (int p = 0; p < PHASES_COUNT; ++p) {
+        out << (p == 0 ? "\n" : ",\n") << "    \"" << PHASE_NAMES[p] << "\": ";
+        mPhases[p].writeJson(out);
+    }
+    out << "\n  },\n";
+
+    std::vector<std::pair<uint64_t, int>> slowest(mSlowestGraphs);
+    std::sort(slowest.begin(), slowest.end(), std::greater<std::pair<uint64_t, int>>());
+    out << "  \"slowest_graphs\": [";
+    for (size_t k = 0; k < slowest.size(); ++k) {
+        out << (k == 0 ? "" : ", ") << "{\"graph\": " << slowest[k].second << ", \"ns\": " << slowest[k].first << "}";
+    }
+    out << "],\n";
+
+    out << "  \"sat\": {\"conflicts\": " << mConflicts << ", \"decisions\": " << mDecisions << ", \"propagations\": " << mPropagations << "}\n";
+    out << "}\n";
+}
+
+
+void MEDTester::Profiler::Histogram::add(uint64_t nanos)
+{
+    if (buckets.empty()) buckets.assign(BUCKETS_COUNT, 0);
+
+    size_t bucket = 0;
+    while (bucket + 1 < BUCKETS_COUNT && (nanos >> (bucket + 1)) != 0) ++bucket;
+    ++buckets[bucket];
+    ++count;
+    totalNanos += nanos;
+    maxNanos = std::max(maxNanos, nanos);
+}
+
+void MEDTester::Profiler::Histogram::merge(const Histogram& other)
+{
+    if (other.buckets.empty()) return;
+    if (buckets.empty()) buckets.assign(BUCKETS_COUNT, 0);
+
+    for (size_t k = 0; k < BUCKETS_COUNT; ++k) buckets[k] += other.buckets[k];
+    count += other.count;
+    totalNanos += other.totalNanos;
+    maxNanos = std::max(maxNanos, other.maxNanos);
+}
+
+/* Only non-empty buckets are written, each with its (exclusive) upper bound. */
+void MEDTester::Profiler::Histogram::writeJson(std::ostream& out) const
+{
+    out << "{\"count\": " << count << ", \"total_ns\": " << totalNanos << ", \"mean_ns\": " << (count > 0 ? totalNanos / count : 0)
+        << ", \"max_ns\": " << maxNanos << ", \"histogram\": [";
+    bool first = true;
+    for (size_t k = 0; k < buckets.size(); ++k) {
+        if (buckets[k] == 0) continue;
+        out << (first ? "" : ", ") << "{\"below_ns\": " << ((uint64_t) 1 << (k + 1)) << ", \"count\": " << buckets[k] << "}";
+        first = false;
+    }
+    out << "]}";
+}
+
+/* Peak resident memory of the process in kB (0 if unknown). The high-water mark of the current
+ * address space is used (VmHWM), the maximal RSS of getrusage also counts the memory of the parent
+ * process before exec, which distorts the measurement of small runs. */
+uint64_t MEDTester::Profiler::getPeakMemory()
+{
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key) {
+        if (key == "VmHWM:") {
+            uint64_t kilobytes = 0;
+            status >> kilobytes;
+            return kilobytes;
+        }
+        status.ignore(256, '\n');
+    }
+    return 0;
+}
@@ -0,0 +1,912 @@
+#include "Reducer.h"
+
+#include "typedefs.h"
+#include "CubicGraph.h"
+#include "SatSolver.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+
+#define COMPACT_VARS_COUNT 4
+
+
+const int MEDTester::Reducer::MAX_BOUNDARY_SIZE = 4;
+const int MEDTester::Reducer::MIN_CYCLIC_CUT_WEIGHT = 20;
+const int MEDTester::Reducer::MAX_SIGNATURES_COUNT = 64;
+
+
+MEDTester::Reducer::Reducer(const MEDTester::CubicGraph& graph, std::atomic<bool>* interrupt) : mGraph(graph)
+{
+    mInterrupt = interrupt;
+    mDecomposable = false;
+    mInterrupted = false;
+    mDecompositionDone = false;
+    mOwners.assign(mGraph.getVerticesCount(), -1);
+    mSlotEnds.assign(3 * mGraph.getVerticesCount(), -1);
+    reduce();
+}
+
+/* Only finds the table of the cycle on the first vertices of the graph, for findCycleSignatures. */
+MEDTester::Reducer::Reducer(const MEDTester::CubicGraph& graph, int cycleLength) : mGraph(graph)
+{
+    mInterrupt = nullptr;
+    mDecomposable = false;
+    mInterrupted = false;
+    mDecompositionDone = false;
+    mOwners.assign(mGraph.getVerticesCount(), -1);
+    mSlotEnds.assign(3 * mGraph.getVerticesCount(), -1);
+
+    Piece piece;
+    for (int v = 0; v < cycleLength; ++v) {
+        piece.vertices.push_back(v);
+        piece.boundary.push_back(mGraph.getEdgeId(v, 2));
+        piece.innerSlots.push_back(3*v + 2);
+    }
+    mPieces.push_back(std::move(piece));
+    findSignatures(0);
+}
+
+MEDTester::Reducer::~Reducer() {}
+
+
+bool MEDTester::Reducer::isReduced() const
+{
+    return !mPieces.empty();
+}
+
+bool MEDTester::Reducer::isDecomposable() const
+{
+    return mDecomposable;
+}
+
+bool MEDTester::Reducer::isInterrupted() const
+{
+    return mInterrupted;
+}
+
+MEDTester::Decomposition MEDTester::Reducer::getDecomposition()
+{
+    if (!mDecompositionDone) {
+        liftDecomposition();
+        mDecompositionDone = true;
+    }
+    return mDecomposition;
+}
+
+int MEDTester::Reducer::getKernelVerticesCount() const
+{
+    return mKernel.size();
+}
+
+const MEDTester::SatSolver::Stats& MEDTester::Reducer::getStats() const
+{
+    return mStats;
+}
+
+
+/* Pieces are cut off one by one, each time the one with the fewest vertices of the kernel, until
+ * there is no small cut left. Signatures of a piece are found right away, so a piece without them
+ * stops the reduction. */
+void MEDTester::Reducer::reduce()
+{
+    int verticesCount = mGraph.getVerticesCount();
+    bool decided = false;
+    Piece piece;
+    mCutSearched.assign(verticesCount, false);
+    while (!decided && findPiece(piece)) {
+        int id = mPieces.size();
+        mCutSearched.resize(verticesCount + id);
+        mCutSearched.push_back(false);
+        for (int v : piece.vertices) mOwners[v] = id;
+        for (int p : piece.nested) mPieces[p].parent = id;
+        bool isCycle = piece.isCycle;
+        mPieces.push_back(std::move(piece));
+        piece = Piece();
+        if (isCycle) mPieces[id].signatures = getCycleSignatures(mPieces[id].vertices.size());
+        else decided = !findSignatures(id);
+
+        /* Tables of pieces joining several earlier ones can grow large, such a piece is put back and
+         * the reduction stops. */
+        if ((int) mPieces[id].signatures.size() > MAX_SIGNATURES_COUNT) {
+            for (int v : mPieces[id].vertices) mOwners[v] = -1;
+            for (int p : mPieces[id].nested) mPieces[p].parent = -1;
+            mPieces.pop_back();
+            break;
+        }
+    }
+
+    for (int v = 0; v < verticesCount; ++v) {
+        if (mOwners[v] == -1) mKernel.push_back(v);
+    }
+    if (mPieces.empty() || decided) return;
+    solveKernel();
+}
+
+/* Outermost piece containing the vertex, owners of vertices are moved to it on the way. */
+int MEDTester::Reducer::findOwner(int vertex)
+{
+    int piece = mOwners[vertex];
+    if (piece == -1) return -1;
+    while (mPieces[piece].parent != -1) piece = mPieces[piece].parent;
+    mOwners[vertex] = piece;
+    return piece;
+}
+
+/* Current graph has a node for each kernel vertex and for each outermost piece (vertex v is node v,
+ * piece p is node n+p), edges inside the pieces are left out. */
+void MEDTester::Reducer::buildCurrentGraph()
+{
+    int verticesCount = mGraph.getVerticesCount();
+    int nodesCount = verticesCount + mPieces.size();
+    mNodes.resize(verticesCount);
+    for (int v = 0; v < verticesCount; ++v) {
+        int owner = findOwner(v);
+        mNodes[v] = owner == -1 ? v : verticesCount + owner;
+    }
+
+    mAdjStart.assign(nodesCount + 1, 0);
+    for (int e = 0; e < mGraph.getEdgesCount(); ++e) {
+        std::pair<int, int> edge = mGraph.getEdge(e);
+        int a = mNodes[edge.first];
+        int b = mNodes[edge.second];
+        if (a == b) continue;
+        ++mAdjStart[a + 1];
+        ++mAdjStart[b + 1];
+    }
+    for (int x = 0; x < nodesCount; ++x) mAdjStart[x + 1] += mAdjStart[x];
+
+    mAdj.resize(mAdjStart[nodesCount]);
+    std::vector<int> positions(mAdjStart.begin(), mAdjStart.end() - 1);
+    for (int e = 0; e < mGraph.getEdgesCount(); ++e) {
+        std::pair<int, int> edge = mGraph.getEdge(e);
+        int a = mNodes[edge.first];
+        int b = mNodes[edge.second];
+        if (a == b) continue;
+        mAdj[positions[a]++] = {b, e};
+        mAdj[positions[b]++] = {a, e};
+    }
+}
+
+/* Bridges and 2-edge-cuts are found by one DFS - each non-tree edge gets a random label and each tree
+ * edge the XOR of the labels of the non-tree edges going over it. A tree edge with label 0 is a bridge
+ * and two edges with the same label form a 2-edge-cut (with a negligible chance of a false match, which
+ * only makes the boundary of the piece larger, so it is checked). Tree edges with the same label lie
+ * on one path from the root, the pieces are the parts between the consecutive ones. */
+bool MEDTester::Reducer::findPiece(MEDTester::Reducer::Piece& piece)
+{
+    buildCurrentGraph();
+    int verticesCount = mGraph.getVerticesCount();
+    int nodesCount = verticesCount + mPieces.size();
+
+    mOrder.assign(nodesCount, -1);
+    mParents.assign(nodesCount, -1);
+    mParentEdges.assign(nodesCount, -1);
+    mSubtreeSizes.assign(nodesCount, 1);
+    mSubtreeWeights.assign(nodesCount, 0);
+    mLabels.assign(nodesCount, 0);
+    mNodesInOrder.clear();
+    std::unordered_set<uint64_t> backEdgeLabels;
+
+    std::vector<std::pair<int, int>> stack;
+    for (int root = 0; root < nodesCount; ++root) {
+        bool isActive = root < verticesCount ? mOwners[root] == -1 : mPieces[root - verticesCount].parent == -1;
+        if (!isActive || mOrder[root] != -1) continue;
+
+        mOrder[root] = mNodesInOrder.size();
+        mNodesInOrder.push_back(root);
+        stack.push_back({root, mAdjStart[root]});
+        while (!stack.empty()) {
+            int x = stack.back().first;
+            int position = stack.back().second;
+            if (position == mAdjStart[x + 1]) {
+                stack.pop_back();
+                continue;
+            }
+            ++stack.back().second;
+
+            int y = mAdj[position].first;
+            int e = mAdj[position].second;
+            if (e == mParentEdges[x]) continue;
+            if (mOrder[y] == -1) {
+                mOrder[y] = mNodesInOrder.size();
+                mNodesInOrder.push_back(y);
+                mParents[y] = x;
+                mParentEdges[y] = e;
+                stack.push_back({y, mAdjStart[y]});
+            } else if (mOrder[y] < mOrder[x]) {
+                uint64_t label = mRandom();
+                mLabels[x] ^= label;
+                mLabels[y] ^= label;
+                backEdgeLabels.insert(label);
+            }
+        }
+    }
+
+    for (int x : mNodesInOrder) {
+        if (x < verticesCount) mSubtreeWeights[x] = 1;
+    }
+    for (size_t k = mNodesInOrder.size(); k-- > 0;) {
+        int x = mNodesInOrder[k];
+        if (mParents[x] == -1) continue;
+        mSubtreeSizes[mParents[x]] += mSubtreeSizes[x];
+        mSubtreeWeights[mParents[x]] += mSubtreeWeights[x];
+        mLabels[mParents[x]] ^= mLabels[x];
+    }
+    int totalWeight = 0;
+    for (int x : mNodesInOrder) {
+        if (x < verticesCount) ++totalWeight;
+    }
+
+    std::vector<Candidate> candidates;
+    auto addCandidate = [&] (int weight, int boundarySize, int inside, int outside, bool complement) {
+        if (weight < 1 || weight > totalWeight - 1) return;
+        candidates.push_back({weight, boundarySize, inside, outside, complement, {}});
+    };
+
+    std::unordered_map<uint64_t, std::vector<int>> groups;
+    for (int x : mNodesInOrder) {
+        if (mParents[x] == -1) continue;
+        if (mLabels[x] == 0) {
+            addCandidate(mSubtreeWeights[x], 1, x, -1, false);
+            addCandidate(totalWeight - mSubtreeWeights[x], 1, x, -1, true);
+        } else {
+            groups[mLabels[x]].push_back(x);
+        }
+    }
+    for (const auto& group : groups) {
+        const std::vector<int>& children = group.second;      // In the DFS order, so from the root.
+        for (size_t k = 0; k + 1 < children.size(); ++k) {
+            addCandidate(mSubtreeWeights[children[k]] - mSubtreeWeights[children[k + 1]], 2, children[k], children[k + 1], false);
+        }
+        if (backEdgeLabels.count(group.first)) {
+            addCandidate(mSubtreeWeights[children.back()], 2, children.back(), -1, false);
+            addCandidate(totalWeight - mSubtreeWeights[children.front()], 2, children.front(), -1, true);
+        }
+    }
+    addSmallCycles(candidates, totalWeight);
+
+    std::sort(candidates.begin(), candidates.end(), [] (const Candidate& a, const Candidate& b) {
+        return a.weight != b.weight ? a.weight < b.weight : a.boundarySize < b.boundarySize;
+    });
+
+    bool isFound = false;
+    int weight = totalWeight;
+    std::vector<bool> isMember(nodesCount);
+    for (const Candidate& candidate : candidates) {
+        auto isInSubtree = [&] (int x, int root) {
+            return mOrder[x] >= mOrder[root] && mOrder[x] < mOrder[root] + mSubtreeSizes[root];
+        };
+
+        std::fill(isMember.begin(), isMember.end(), false);
+        if (!candidate.vertices.empty()) {
+            for (int v : candidate.vertices) isMember[v] = true;
+        } else {
+            for (int x : mNodesInOrder) {
+                bool inside = isInSubtree(x, candidate.inside) && !(candidate.outside != -1 && isInSubtree(x, candidate.outside));
+                isMember[x] = candidate.complement ? !inside : inside;
+            }
+        }
+
+        if (candidate.vertices.empty()) {
+            if (!fillPiece(isMember, piece)) continue;
+        } else {
+            /* Boundary of a triangle or a square goes in the order of the cycle, so it can use the common table. */
+            piece.boundary.clear();
+            piece.innerSlots.clear();
+            for (int v : candidate.vertices) {
+                for (int i = 0; i < 3; ++i) {
+                    if (isMember[mNodes[mGraph.getNeighbour(v, i)]]) continue;
+                    piece.boundary.push_back(mGraph.getEdgeId(v, i));
+                    piece.innerSlots.push_back(3*v + i);
+                }
+            }
+            if ((int) piece.boundary.size() > MAX_BOUNDARY_SIZE) continue;
+            piece.vertices = candidate.vertices;
+            piece.isCycle = piece.boundary.size() == piece.vertices.size();
+        }
+        isFound = true;
+        weight = candidate.weight;
+        break;
+    }
+
+    /* Cyclic cuts are searched only if the pieces found so far are large (a search costs a few max flows
+     * from each node). */
+    if (isFound && weight < MIN_CYCLIC_CUT_WEIGHT) return true;
+    Piece cut;
+    if (!findCyclicCut(cut, totalWeight, weight)) return isFound;
+    piece = std::move(cut);
+    return true;
+}
+
+/* Boundary, vertices and nested pieces of the piece made of the given nodes of the current graph. */
+bool MEDTester::Reducer::fillPiece(const std::vector<bool>& isMember, MEDTester::Reducer::Piece& piece) const
+{
+    piece.boundary.clear();
+    piece.innerSlots.clear();
+    for (int e = 0; e < mGraph.getEdgesCount() && (int) piece.boundary.size() <= MAX_BOUNDARY_SIZE; ++e) {
+        std::pair<int, int> slot = mGraph.getEdgeSlot(e);
+        int u = slot.first;
+        int w = mGraph.getNeighbour(u, slot.second);
+        if (isMember[mNodes[u]] == isMember[mNodes[w]]) continue;
+        piece.boundary.push_back(e);
+        piece.innerSlots.push_back(isMember[mNodes[u]] ? 3*u + slot.second : 3*w + mGraph.getReverseIndex(u, slot.second));
+    }
+    if ((int) piece.boundary.size() > MAX_BOUNDARY_SIZE) return false;
+
+    for (int x : mNodesInOrder) {
+        if (!isMember[x]) continue;
+        if (x < mGraph.getVerticesCount()) piece.vertices.push_back(x);
+        else piece.nested.push_back(x - mGraph.getVerticesCount());
+    }
+    return true;
+}
+
+/* Cyclic 3- and 4-edge-cuts (both sides contain a cycle) are searched around each node once, the
+ * smaller side of each cut found is kept as a set of vertices. A kept side is still a
+ * cut after other pieces are cut off if each of them is inside it or outside, so the searches are
+ * repeated only for new nodes once the kept sides run out. The smallest side with fewer kernel
+ * vertices than the given number is the next piece. */
+bool MEDTester::Reducer::findCyclicCut(MEDTester::Reducer::Piece& piece, int totalWeight, int maxWeight)
+{
+    if (totalWeight < MIN_CYCLIC_CUT_WEIGHT) return false;
+
+    int verticesCount = mGraph.getVerticesCount();
+    int nodesCount = verticesCount + mPieces.size();
+    std::vector<bool> isMember(nodesCount);
+    for (int x : mNodesInOrder) {
+        int cutSize = 0;
+        if (mCutSearched[x]) continue;
+        mCutSearched[x] = true;
+        if (!findCutAround(x, isMember, cutSize)) continue;
+
+        CutSide side = {0, cutSize, std::vector<bool>(verticesCount)};
+        for (int v = 0; v < verticesCount; ++v) side.size += isMember[mNodes[v]];
+        bool isComplement = 2 * side.size > verticesCount;
+        for (int v = 0; v < verticesCount; ++v) side.vertices[v] = isMember[mNodes[v]] != isComplement;
+        if (isComplement) side.size = verticesCount - side.size;
+        mCutSides.push_back(std::move(side));
+    }
+
+    /* Sides are checked from the smallest one (counting the vertices of the pieces in it too, so that
+     * pieces are not grown by single vertices), the ones which are not cuts any more are removed. */
+    std::sort(mCutSides.begin(), mCutSides.end(), [] (const CutSide& a, const CutSide& b) {
+        return a.size != b.size ? a.size < b.size : a.cutSize < b.cutSize;
+    });
+
+    size_t kept = 0;
+    bool isFound = false;
+    for (size_t k = 0; k < mCutSides.size(); ++k) {
+        CutSide& side = mCutSides[k];
+        std::fill(isMember.begin(), isMember.end(), false);
+        for (int v = 0; v < verticesCount; ++v) {
+            if (side.vertices[v]) isMember[mNodes[v]] = true;
+        }
+        bool isLaminar = true;
+        for (int v = 0; v < verticesCount; ++v) {
+            if (isMember[mNodes[v]] != side.vertices[v]) isLaminar = false;
+        }
+
+        int weight = 0;
+        for (int x : mNodesInOrder) weight += isMember[x] && x < verticesCount;
+        if (!isLaminar || weight < 1 || weight > totalWeight - 1) continue;
+        if (!isFound && weight < maxWeight && fillPiece(isMember, piece)) {
+            isFound = true;
+            continue;
+        }
+        if (kept != k) mCutSides[kept] = std::move(side);
+        ++kept;
+    }
+    mCutSides.resize(kept);
+    return isFound;
+}
+
+/* Max flow from the closed neighbourhood of the node to the nodes farther than a radius, which grows
+ * until the flow is at most MAX_BOUNDARY_SIZE and both sides of the minimum cut contain a cycle (a
+ * side contains one if it has a nested piece or at least as many edges as nodes). The side of the
+ * node is the one reachable from it in the residual graph. */
+bool MEDTester::Reducer::findCutAround(int x, std::vector<bool>& isMember, int& cutSize)
+{
+    int verticesCount = mGraph.getVerticesCount();
+    int nodesCount = verticesCount + mPieces.size();
+    mDistances.assign(nodesCount, -1);
+    mQueue.clear();
+    mDistances[x] = 0;
+    mQueue.push_back(x);
+    for (size_t k = 0; k < mQueue.size(); ++k) {
+        int y = mQueue[k];
+        for (int position = mAdjStart[y]; position < mAdjStart[y + 1]; ++position) {
+            int z = mAdj[position].first;
+            if (mDistances[z] != -1) continue;
+            mDistances[z] = mDistances[y] + 1;
+            mQueue.push_back(z);
+        }
+    }
+    int maxDistance = mDistances[mQueue.back()];
+    std::vector<int> component = mQueue;
+
+    mPrevious.resize(nodesCount);
+    for (int radius = 2; radius < maxDistance; ++radius) {
+        mFlows.assign(mGraph.getEdgesCount(), 0);
+
+        /* Augmenting paths in the residual graph, each edge has capacity 1 in both directions. */
+        int flow = 0;
+        bool isSinkReached = true;
+        while (isSinkReached && flow <= MAX_BOUNDARY_SIZE) {
+            isSinkReached = false;
+            std::fill(isMember.begin(), isMember.end(), false);
+            mQueue.clear();
+            for (int y : component) {
+                if (mDistances[y] > 1) continue;
+                isMember[y] = true;
+                mQueue.push_back(y);
+            }
+            for (size_t k = 0; k < mQueue.size() && !isSinkReached; ++k) {
+                int y = mQueue[k];
+                for (int position = mAdjStart[y]; position < mAdjStart[y + 1]; ++position) {
+                    int z = mAdj[position].first;
+                    int e = mAdj[position].second;
+                    bool isForward = mNodes[mGraph.getEdge(e).first] == y;
+                    if (isMember[z] || (isForward ? mFlows[e] : -mFlows[e]) == 1) continue;
+                    isMember[z] = true;
+                    mPrevious[z] = {y, e};
+                    if (mDistances[z] > radius) {
+                        for (int w = z; mDistances[w] > 1; w = mPrevious[w].first) {
+                            int edge = mPrevious[w].second;
+                            mFlows[edge] += mNodes[mGraph.getEdge(edge).first] == mPrevious[w].first ? 1 : -1;
+                        }
+                        ++flow;
+                        isSinkReached = true;
+                        break;
+                    }
+                    mQueue.push_back(z);
+                }
+            }
+        }
+        if (flow > MAX_BOUNDARY_SIZE) continue;
+
+        int sourceNodes = 0, sourceEdges = 0, sinkNodes = 0, sinkEdges = 0;
+        bool sourceHasPiece = false, sinkHasPiece = false;
+        for (int y : component) {
+            int& nodes = isMember[y] ? sourceNodes : sinkNodes;
+            ++nodes;
+            if (y >= verticesCount) (isMember[y] ? sourceHasPiece : sinkHasPiece) = true;
+            for (int position = mAdjStart[y]; position < mAdjStart[y + 1]; ++position) {
+                int z = mAdj[position].first;
+                if (isMember[y] != isMember[z] || z < y) continue;
+                ++(isMember[y] ? sourceEdges : sinkEdges);
+            }
+        }
+        bool isSourceCyclic = sourceHasPiece || sourceEdges >= sourceNodes;
+        bool isSinkCyclic = sinkHasPiece || sinkEdges >= sinkNodes;
+        if (isSourceCyclic && isSinkCyclic) {
+            cutSize = flow;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Triangles and squares of the kernel vertices, each found once from its smallest vertex. */
+void MEDTester::Reducer::addSmallCycles(std::vector<MEDTester::Reducer::Candidate>& candidates, int totalWeight)
+{
+    if (totalWeight <= 4) return;
+
+    auto isKernel = [&] (int v) { return mOwners[v] == -1; };
+    for (int v = 0; v < mGraph.getVerticesCount(); ++v) {
+        if (!isKernel(v)) continue;
+        for (int k1 = 0; k1 < 2; ++k1) {
+            for (int k2 = k1 + 1; k2 < 3; ++k2) {
+                int x = mGraph.getNeighbour(v, k1);
+                int y = mGraph.getNeighbour(v, k2);
+                if (x == y || x < v || y < v || !isKernel(x) || !isKernel(y)) continue;
+
+                if (mGraph.getIndex(x, y) != -1) {
+                    candidates.push_back({3, 3, -1, -1, false, {v, x, y}});
+                }
+                for (int k = 0; k < 3; ++k) {
+                    int z = mGraph.getNeighbour(x, k);
+                    if (z == v || z == y || z < v || !isKernel(z) || mGraph.getIndex(y, z) == -1) continue;
+                    candidates.push_back({4, 4, -1, -1, false, {v, x, z, y}});
+                }
+            }
+        }
+    }
+}
+
+/* Enumerates the states of the boundary edges of the piece which can be extended into it, each found
+ * signature is blocked by a clause. */
+bool MEDTester::Reducer::findSignatures(int id)
+{
+    auto timeStart = std::chrono::steady_clock::now();
+    MEDTester::SatBackend solver(nullptr, mInterrupt);
+    Scope scope;
+    scope.vertices = mPieces[id].vertices;
+    scope.nested = mPieces[id].nested;
+    buildScope(solver, scope, mPieces[id].boundary, mPieces[id].innerSlots);
+    mStats.theoryNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+    Piece& piece = mPieces[id];
+    while (true) {
+        MEDTester::SatValue result = solve(solver);
+        if (result == MEDTester::SAT_UNDEF) {
+            mInterrupted = true;
+            return false;
+        }
+        if (result != MEDTester::SAT_TRUE) break;
+
+        const std::vector<MEDTester::SatValue>& model = solver.get_model();
+        std::vector<uint8_t> signature;
+        MEDTester::Clause blockingClause;
+        for (size_t i = 0; i < piece.boundary.size(); ++i) {
+            uint8_t state = readState(scope, model, piece.boundary[i], scope.boundaryCycleLits[i], scope.boundaryLeafLits[i]);
+            signature.push_back(state);
+            for (MEDTester::SatLit lit : stateLits(scope, piece.boundary[i], scope.boundaryCycleLits[i], scope.boundaryLeafLits[i], state)) {
+                blockingClause.push_back(~lit);
+            }
+        }
+        piece.signatures.push_back(std::move(signature));
+        if (blockingClause.empty() || (int) piece.signatures.size() > MAX_SIGNATURES_COUNT) break;
+        solver.add_clause(blockingClause);
+    }
+
+    return !piece.signatures.empty();
+}
+
+/* A triangle or a square without chords has the same table in every graph (with the boundary in the
+ * order of the cycle), so it is found once in the prism over the cycle. */
+const std::vector<std::vector<uint8_t>>& MEDTester::Reducer::getCycleSignatures(int length)
+{
+    static const std::vector<std::vector<uint8_t>> triangleSignatures = findCycleSignatures(3);
+    static const std::vector<std::vector<uint8_t>> squareSignatures = findCycleSignatures(4);
+    return length == 3 ? triangleSignatures : squareSignatures;
+}
+
+std::vector<std::vector<uint8_t>> MEDTester::Reducer::findCycleSignatures(int length)
+{
+    MEDTester::FlatAdjList adjList(6 * length);
+    for (int i = 0; i < length; ++i) {
+        adjList[3*i] = (i + 1) % length;
+        adjList[3*i + 1] = (i + length - 1) % length;
+        adjList[3*i + 2] = length + i;
+        adjList[3*(length + i)] = length + (i + 1) % length;
+        adjList[3*(length + i) + 1] = length + (i + length - 1) % length;
+        adjList[3*(length + i) + 2] = i;
+    }
+
+    Reducer reducer(MEDTester::CubicGraph(adjList), length);
+    return reducer.mPieces[0].signatures;
+}
+
+/* Selected signatures of the outermost pieces and the types of the kernel edges are kept for the
+ * decomposition, the pieces are solved again only if it is needed. */
+void MEDTester::Reducer::solveKernel()
+{
+    auto timeStart = std::chrono::steady_clock::now();
+    MEDTester::SatBackend solver(nullptr, mInterrupt);
+    Scope scope;
+    scope.vertices = mKernel;
+    for (size_t p = 0; p < mPieces.size(); ++p) {
+        if (mPieces[p].parent == -1) scope.nested.push_back(p);
+    }
+    buildScope(solver, scope, {}, {});
+    mStats.theoryNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+    MEDTester::SatValue result = solve(solver);
+    mInterrupted = result == MEDTester::SAT_UNDEF;
+    mDecomposable = result == MEDTester::SAT_TRUE;
+    if (mDecomposable) {
+        mDecomposition = MEDTester::Decomposition(mGraph.getVerticesCount(), std::vector<MEDTester::EdgeType>(3, MEDTester::EdgeType::NONE));
+        readSolution(scope, solver.get_model());
+    }
+}
+
+/* The selected signature is among the ones found in the piece, so the piece is satisfiable with it
+ * (the solver is not interrupted here, it is fast and the graph is decided already). */
+void MEDTester::Reducer::liftDecomposition()
+{
+    if (!mDecomposable) return;
+
+    std::vector<int> stack;
+    for (size_t p = 0; p < mPieces.size(); ++p) {
+        if (mPieces[p].parent == -1) stack.push_back(p);
+    }
+    while (!stack.empty()) {
+        const Piece& piece = mPieces[stack.back()];
+        stack.pop_back();
+
+        MEDTester::SatBackend solver;
+        Scope scope;
+        scope.vertices = piece.vertices;
+        scope.nested = piece.nested;
+        buildScope(solver, scope, piece.boundary, piece.innerSlots);
+
+        std::vector<MEDTester::SatLit> assumptions;
+        for (size_t i = 0; i < piece.boundary.size(); ++i) {
+            for (MEDTester::SatLit lit : stateLits(scope, piece.boundary[i], scope.boundaryCycleLits[i], scope.boundaryLeafLits[i], piece.signatures[piece.selected][i])) {
+                assumptions.push_back(lit);
+            }
+        }
+        if (solve(solver, &assumptions) != MEDTester::SAT_TRUE) continue;
+        readSolution(scope, solver.get_model());
+        for (int p : piece.nested) stack.push_back(p);
+    }
+}
+
+
+MEDTester::SatLit MEDTester::Reducer::edgeLit(const MEDTester::Reducer::Scope& scope, int edge, MEDTester::CompactVar var, bool isInverted) const
+{
+    return MEDTester::SatLit(scope.edgeVars[edge] + (int) var, isInverted);
+}
+
+/* Same clauses as in the compact encoding of SatSolver, except that an end of an edge can be in a
+ * nested piece - then its variables (whether it is a cycle vertex and has a leaf edge) are set by the
+ * selected signature of the piece. Edges leaving the scope get only the clauses of their inner end. */
+void MEDTester::Reducer::buildScope(MEDTester::SatBackend& solver, MEDTester::Reducer::Scope& scope, const std::vector<int>& boundary, const std::vector<int>& innerSlots)
+{
+    std::vector<int> edges;
+    scope.edgeVars.assign(mGraph.getEdgesCount(), -1);
+    auto addEdge = [&] (int e) {
+        if (scope.edgeVars[e] != -1) return;
+        scope.edgeVars[e] = solver.nVars() + COMPACT_VARS_COUNT * edges.size();
+        edges.push_back(e);
+    };
+    for (int v : scope.vertices) {
+        for (int i = 0; i < 3; ++i) {
+            addEdge(mGraph.getEdgeId(v, i));
+            mSlotEnds[3*v + i] = -2;
+        }
+    }
+    for (size_t q = 0; q < scope.nested.size(); ++q) {
+        const Piece& piece = mPieces[scope.nested[q]];
+        for (size_t i = 0; i < piece.boundary.size(); ++i) {
+            addEdge(piece.boundary[i]);
+            mSlotEnds[piece.innerSlots[i]] = q * MAX_BOUNDARY_SIZE + i;
+        }
+    }
+    solver.new_vars(COMPACT_VARS_COUNT * edges.size());
+
+    /* Each edge has at most one of the types, matching edge has none, and parity only cycle edges. */
+    for (int e : edges) {
+        MEDTester::SatLit cycleLit = edgeLit(scope, e, MEDTester::CompactVar::CYCLE, true);
+        MEDTester::SatLit starCenterLit = edgeLit(scope, e, MEDTester::CompactVar::STAR_CENTER, true);
+        MEDTester::SatLit starLeafLit = edgeLit(scope, e, MEDTester::CompactVar::STAR_LEAF, true);
+        solver.add_clause({cycleLit, starCenterLit});
+        solver.add_clause({cycleLit, starLeafLit});
+        solver.add_clause({starCenterLit, starLeafLit});
+        solver.add_clause({~cycleLit, edgeLit(scope, e, MEDTester::CompactVar::PARITY, true)});
+    }
+
+    for (int v : scope.vertices) {
+        auto lit = [&] (int i, MEDTester::CompactVar var, bool isInverted) {
+            return edgeLit(scope, mGraph.getEdgeId(v, i), var, isInverted);
+        };
+
+        /* Even number of cycle edges (not three) and their parities differ. */
+        for (int inverted = 0; inverted < 4; ++inverted) {
+            MEDTester::Clause clause;
+            for (int i = 0; i < 3; ++i) clause.push_back(lit(i, MEDTester::CompactVar::CYCLE, inverted == 0 || inverted == i + 1));
+            solver.add_clause(clause);
+        }
+        for (int i = 0; i < 2; ++i) {
+            for (int k = i + 1; k < 3; ++k) {
+                for (bool isInverted : {false, true}) {
+                    solver.add_clause({
+                        lit(i, MEDTester::CompactVar::CYCLE, true),
+                        lit(k, MEDTester::CompactVar::CYCLE, true),
+                        lit(i, MEDTester::CompactVar::PARITY, isInverted),
+                        lit(k, MEDTester::CompactVar::PARITY, isInverted)
+                    });
+                }
+            }
+        }
+
+        /* Vertex without cycle edges is a double-star center. */
+        solver.add_clause({
+            lit(0, MEDTester::CompactVar::CYCLE, false),
+            lit(1, MEDTester::CompactVar::CYCLE, false),
+            lit(0, MEDTester::CompactVar::STAR_CENTER, false),
+            lit(1, MEDTester::CompactVar::STAR_CENTER, false),
+            lit(2, MEDTester::CompactVar::STAR_CENTER, false)
+        });
+        for (int i = 0; i < 3; ++i) {
+            solver.add_clause({lit(i, MEDTester::CompactVar::STAR_CENTER, true), lit((i+1)%3, MEDTester::CompactVar::STAR_LEAF, false)});
+            solver.add_clause({lit(i, MEDTester::CompactVar::STAR_CENTER, true), lit((i+2)%3, MEDTester::CompactVar::STAR_LEAF, false)});
+        }
+    }
+
+    /* Nested piece has one of its signatures, which sets the types of its boundary edges and the
+     * variables of their inner ends. */
+    scope.rowVars.clear();
+    scope.endVars.clear();
+    for (int p : scope.nested) {
+        const Piece& piece = mPieces[p];
+        int rowVar = solver.nVars();
+        int endVar = rowVar + piece.signatures.size();
+        scope.rowVars.push_back(rowVar);
+        scope.endVars.push_back(endVar);
+        solver.new_vars(piece.signatures.size() + 2 * piece.boundary.size());
+
+        MEDTester::Clause clause;
+        for (size_t r = 0; r < piece.signatures.size(); ++r) clause.push_back(MEDTester::SatLit(rowVar + r, false));
+        solver.add_clause(clause);
+
+        for (size_t r = 0; r < piece.signatures.size(); ++r) {
+            MEDTester::SatLit rowLit(rowVar + r, true);
+            for (size_t i = 0; i < piece.boundary.size(); ++i) {
+                uint8_t state = piece.signatures[r][i];
+                MEDTester::SatLit cycleVertexLit(endVar + 2*i, false);
+                MEDTester::SatLit hasLeafLit(endVar + 2*i + 1, false);
+                std::vector<MEDTester::SatLit> lits = stateLits(scope, piece.boundary[i], cycleVertexLit, hasLeafLit, state);
+                bool isCycleVertex = state != STAR_CENTER && state != LEAF_AT_CENTER;
+                bool hasLeaf = state == STAR_CENTER || state == LEAF_AT_CENTER || (state >= CYCLE && (state - CYCLE) & 2);
+                lits.push_back(isCycleVertex ? cycleVertexLit : ~cycleVertexLit);
+                lits.push_back(hasLeaf ? hasLeafLit : ~hasLeafLit);
+                for (MEDTester::SatLit lit : lits) solver.add_clause({rowLit, lit});
+            }
+        }
+    }
+
+    /* Double-star leaf edge joins a cycle vertex with a double-star center and double-stars are
+     * independent (no edge except the center has leaf edges at both ends). */
+    for (int e : edges) {
+        std::pair<int, int> slot = mGraph.getEdgeSlot(e);
+        int u = slot.first;
+        int w = mGraph.getNeighbour(u, slot.second);
+        int slotU = 3*u + slot.second;
+        int slotW = 3*w + mGraph.getReverseIndex(u, slot.second);
+        if (mSlotEnds[slotU] == -1 || mSlotEnds[slotW] == -1) continue;
+
+        MEDTester::SatLit cycleVertexU, cycleVertexW;
+        std::vector<MEDTester::SatLit> leavesU, leavesW;
+        addEnd(scope, slotU, cycleVertexU, leavesU);
+        addEnd(scope, slotW, cycleVertexW, leavesW);
+
+        MEDTester::SatLit starLeafLit = edgeLit(scope, e, MEDTester::CompactVar::STAR_LEAF, true);
+        solver.add_clause({starLeafLit, cycleVertexU, cycleVertexW});
+        solver.add_clause({starLeafLit, ~cycleVertexU, ~cycleVertexW});
+        for (MEDTester::SatLit a : leavesU) {
+            for (MEDTester::SatLit b : leavesW) {
+                solver.add_clause({edgeLit(scope, e, MEDTester::CompactVar::STAR_CENTER, false), ~a, ~b});
+            }
+        }
+    }
+
+    /* Inner ends of the boundary edges of the scope, with a variable telling if there is a leaf edge. */
+    scope.boundaryCycleLits.clear();
+    scope.boundaryLeafLits.clear();
+    for (int slot : innerSlots) {
+        MEDTester::SatLit cycleVertex;
+        std::vector<MEDTester::SatLit> leaves;
+        addEnd(scope, slot, cycleVertex, leaves);
+        scope.boundaryCycleLits.push_back(cycleVertex);
+        if (leaves.size() == 1) {
+            scope.boundaryLeafLits.push_back(leaves[0]);
+            continue;
+        }
+
+        MEDTester::SatLit hasLeaf(solver.nVars(), false);
+        solver.new_var();
+        solver.add_clause({~hasLeaf, leaves[0], leaves[1]});
+        solver.add_clause({hasLeaf, ~leaves[0]});
+        solver.add_clause({hasLeaf, ~leaves[1]});
+        scope.boundaryLeafLits.push_back(hasLeaf);
+    }
+
+    for (int v : scope.vertices) {
+        for (int i = 0; i < 3; ++i) mSlotEnds[3*v + i] = -1;
+    }
+    for (int p : scope.nested) {
+        for (int slot : mPieces[p].innerSlots) mSlotEnds[slot] = -1;
+    }
+}
+
+/* Literals of an end of an edge (given by its slot) - whether it is a cycle vertex, which is told by
+ * the next edge if the edge is a leaf edge, and the literals of the leaf edges among the other two. */
+void MEDTester::Reducer::addEnd(const MEDTester::Reducer::Scope& scope, int slot, MEDTester::SatLit& cycleVertex, std::vector<MEDTester::SatLit>& leaves) const
+{
+    int end = mSlotEnds[slot];
+    if (end == -2) {
+        int v = slot / 3;
+        int i = slot % 3;
+        cycleVertex = edgeLit(scope, mGraph.getEdgeId(v, (i+1)%3), MEDTester::CompactVar::CYCLE, false);
+        leaves.push_back(edgeLit(scope, mGraph.getEdgeId(v, (i+1)%3), MEDTester::CompactVar::STAR_LEAF, false));
+        leaves.push_back(edgeLit(scope, mGraph.getEdgeId(v, (i+2)%3), MEDTester::CompactVar::STAR_LEAF, false));
+    } else {
+        int endVar = scope.endVars[end / MAX_BOUNDARY_SIZE] + 2 * (end % MAX_BOUNDARY_SIZE);
+        cycleVertex = MEDTester::SatLit(endVar, false);
+        leaves.push_back(MEDTester::SatLit(endVar + 1, false));
+    }
+}
+
+/* Literals which determine the state of the edge (the other variables of its inner end follow from
+ * the clauses of the end). */
+std::vector<MEDTester::SatLit> MEDTester::Reducer::stateLits(const MEDTester::Reducer::Scope& scope, int edge, MEDTester::SatLit cycleVertex, MEDTester::SatLit hasLeaf, uint8_t state) const
+{
+    switch (state) {
+        case MATCHING:
+            return {
+                edgeLit(scope, edge, MEDTester::CompactVar::CYCLE, true),
+                edgeLit(scope, edge, MEDTester::CompactVar::STAR_CENTER, true),
+                edgeLit(scope, edge, MEDTester::CompactVar::STAR_LEAF, true)
+            };
+        case STAR_CENTER:
+            return {edgeLit(scope, edge, MEDTester::CompactVar::STAR_CENTER, false)};
+        case LEAF_AT_CYCLE:
+            return {edgeLit(scope, edge, MEDTester::CompactVar::STAR_LEAF, false), cycleVertex};
+        case LEAF_AT_CENTER:
+            return {edgeLit(scope, edge, MEDTester::CompactVar::STAR_LEAF, false), ~cycleVertex};
+    }
+
+    return {
+        edgeLit(scope, edge, MEDTester::CompactVar::CYCLE, false),
+        edgeLit(scope, edge, MEDTester::CompactVar::PARITY, !((state - CYCLE) & 1)),
+        ((state - CYCLE) & 2) ? hasLeaf : ~hasLeaf
+    };
+}
+
+uint8_t MEDTester::Reducer::readState(const MEDTester::Reducer::Scope& scope, const std::vector<MEDTester::SatValue>& model, int edge, MEDTester::SatLit cycleVertex, MEDTester::SatLit hasLeaf) const
+{
+    auto isTrue = [&] (MEDTester::SatLit lit) {
+        return (model[lit.var()] == MEDTester::SAT_TRUE) != lit.sign();
+    };
+
+    if (isTrue(edgeLit(scope, edge, MEDTester::CompactVar::STAR_CENTER, false))) return STAR_CENTER;
+    if (isTrue(edgeLit(scope, edge, MEDTester::CompactVar::STAR_LEAF, false))) return isTrue(cycleVertex) ? LEAF_AT_CYCLE : LEAF_AT_CENTER;
+    if (isTrue(edgeLit(scope, edge, MEDTester::CompactVar::CYCLE, false))) {
+        return CYCLE + (isTrue(edgeLit(scope, edge, MEDTester::CompactVar::PARITY, false)) ? 1 : 0) + (isTrue(hasLeaf) ? 2 : 0);
+    }
+    return MATCHING;
+}
+
+/* The interrupt flag is checked before solving too, cryptominisat clears it when a solve call starts. */
+MEDTester::SatValue MEDTester::Reducer::solve(MEDTester::SatBackend& solver, const std::vector<MEDTester::SatLit>* assumptions)
+{
+    if (mInterrupt && mInterrupt->load()) return MEDTester::SAT_UNDEF;
+
+    uint64_t conflicts = solver.get_sum_conflicts();
+    uint64_t decisions = solver.get_sum_decisions();
+    uint64_t propagations = solver.get_sum_propagations();
+    auto timeStart = std::chrono::steady_clock::now();
+
+    MEDTester::SatValue result = solver.solve(assumptions);
+
+    mStats.solveNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - timeStart).count();
+    mStats.conflicts += solver.get_sum_conflicts() - conflicts;
+    mStats.decisions += solver.get_sum_decisions() - decisions;
+    mStats.propagations += solver.get_sum_propagations() - propagations;
+    return result;
+}
+
+/* Types of the edges at the vertices of the scope and the signatures selected for its nested pieces. */
+void MEDTester::Reducer::readSolution(const MEDTester::Reducer::Scope& scope, const std::vector<MEDTester::SatValue>& model)
+{
+    auto isTrue = [&] (int var) { return model[var] == MEDTester::SAT_TRUE; };
+
+    for (int v : scope.vertices) {
+        for (int i = 0; i < 3; ++i) {
+            int edgeVar = scope.edgeVars[mGraph.getEdgeId(v, i)];
+            MEDTester::EdgeType type = MEDTester::EdgeType::MATCHING;
+            if (isTrue(edgeVar + (int) MEDTester::CompactVar::CYCLE)) type = MEDTester::EdgeType::CYCLE;
+            else if (isTrue(edgeVar + (int) MEDTester::CompactVar::STAR_CENTER)) type = MEDTester::EdgeType::STAR_CENTER;
+            else if (isTrue(edgeVar + (int) MEDTester::CompactVar::STAR_LEAF)) type = MEDTester::EdgeType::STAR_LEAF;
+            mDecomposition[v][i] = type;
+        }
+    }
+    for (size_t q = 0; q < scope.nested.size(); ++q) {
+        Piece& piece = mPieces[scope.nested[q]];
+        for (size_t r = 0; r < piece.signatures.size(); ++r) {
+            if (isTrue(scope.rowVars[q] + r)) {
+                piece.selected = r;
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#include "ResultCache.h"
+
+#include "typedefs.h"
+#include "CubicGraph.h"
+#include "CanonicalForm.h"
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+
+const size_t MEDTester::ResultCache::MAX_ENTRIES_COUNT = 1 << 20;
+
+
+MEDTester::ResultCache::ResultCache() {}
+
+MEDTester::ResultCache::~ResultCache() {}
+
+
+bool MEDTester::ResultCache::find(const MEDTester::CubicGraph& graph, const MEDTester::CanonicalForm& form, Result& result)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mEntries.find(form.getCertificate());
+    if (it == mEntries.end()) return false;
+
+    const Entry& entry = it->second;
+    result.decomposable = entry.decomposable;
+    result.decompositionsCount = entry.decompositionsCount;
+    result.decomposition.clear();
+
+    if (!entry.decomposition.empty()) {
+        int verticesCount = graph.getVerticesCount();
+        result.decomposition.assign(verticesCount, std::vector<MEDTester::EdgeType>(3, MEDTester::EdgeType::NONE));
+        for (int v = 0; v < verticesCount; ++v) {
+            for (int i = 0; i < 3; ++i) {
+                result.decomposition[v][i] = entry.decomposition[canonicalSlot(graph, form, v, i)];
+            }
+        }
+    }
+    return true;
+}
+
+void MEDTester::ResultCache::insert(const MEDTester::CubicGraph& graph, const MEDTester::CanonicalForm& form, const Result& result)
+{
+    Entry entry;
+    entry.decomposable = result.decomposable;
+    entry.decompositionsCount = result.decompositionsCount;
+
+    if (!result.decomposition.empty()) {
+        entry.decomposition.resize(3 * (size_t) graph.getVerticesCount());
+        for (int v = 0; v < graph.getVerticesCount(); ++v) {
+            for (int i = 0; i < 3; ++i) {
+                entry.decomposition[canonicalSlot(graph, form, v, i)] = result.decomposition[v][i];
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mEntries.size() >= MAX_ENTRIES_COUNT) return;
+    mEntries.emplace(form.getCertificate(), std::move(entry));
+}
+
+
+/* Position of the edge in the certificate - neighbours of each canonical vertex are sorted there. */
+int MEDTester::ResultCache::canonicalSlot(const MEDTester::CubicGraph& graph, const MEDTester::CanonicalForm& form, int vertex, int index)
+{
+    int label = form.getLabel(vertex);
+    int neighbourLabel = form.getLabel(graph.getNeighbour(vertex, index));
+    const int* line = form.getCertificate().data() + 3*label;
+    for (int j = 0; j < 2; ++j) {
+        if (line[j] == neighbourLabel) return 3*label + j;
+    }
+    return 3*label + 2;
+}
+
+size_t MEDTester::ResultCache::CertificateHash::operator()(const std::vector<int>& certificate) const
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (int x : certificate) {
+        hash ^= (uint32_t) x;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,146 @@
+#include "ResultReader.h"
+
+#include "typedefs.h"
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+const char MEDTester::ResultReader::MAGIC[4] = { 'M', 'E', 'D', 'R' };
+const uint8_t MEDTester::ResultReader::VERSION = 1;
+const uint8_t MEDTester::ResultReader::ADJACENCY_FLAG = 1;
+const size_t MEDTester::ResultReader::HEADER_SIZE = 8;
+
+
+MEDTester::ResultReader::ResultReader(const std::string& filename)
+{
+    mData = nullptr;
+    mLength = 0;
+    mPos = 0;
+    mFlags = 0;
+
+    mFd = open(filename.c_str(), O_RDONLY);
+    if (mFd == -1) return;
+
+    struct stat info;
+    if (fstat(mFd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, mFd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, info.st_size, MADV_SEQUENTIAL);
+            mData = static_cast<const unsigned char*>(data);
+            mLength = info.st_size;
+        }
+    }
+
+    if (mLength < HEADER_SIZE || memcmp(mData, MAGIC, sizeof(MAGIC)) != 0 || mData[4] != VERSION) {
+        close();
+        throw WrongFormatException("missing header of the binary result format in file '" + filename + "'.");
+    }
+    mFlags = mData[5];
+    mPos = HEADER_SIZE;
+}
+
+MEDTester::ResultReader::~ResultReader()
+{
+    close();
+}
+
+void MEDTester::ResultReader::close()
+{
+    if (mData) munmap((void*) mData, mLength);
+    if (mFd != -1) ::close(mFd);
+    mData = nullptr;
+    mFd = -1;
+}
+
+
+bool MEDTester::ResultReader::isOpen() const
+{
+    return mFd != -1;
+}
+
+bool MEDTester::ResultReader::hasAdjacency() const
+{
+    return mFlags & ADJACENCY_FLAG;
+}
+
+
+bool MEDTester::ResultReader::next(MEDTester::ResultReader::Record& record)
+{
+    if (mPos == mLength) return false;
+
+    require(9);
+    record.graphNum = (int) readUInt32();
+    uint32_t verticesCount = readUInt32();
+    record.decomposable = mData[mPos++] != 0;
+    if (verticesCount % 2 != 0 || verticesCount > INT_MAX / 3) {
+        throw WrongFormatException("invalid number of vertices in the record of graph " + std::to_string(record.graphNum) + ".");
+    }
+    record.verticesCount = (int) verticesCount;
+
+    record.adjList.clear();
+    if (hasAdjacency()) {
+        require(12 * (size_t) verticesCount);
+        record.adjList.resize(3 * (size_t) verticesCount);
+        for (int& v : record.adjList) v = (int) readUInt32();
+    }
+
+    record.edgeTypes.clear();
+    if (record.decomposable) {
+        size_t edgesCount = 3 * (size_t) verticesCount / 2;
+        require((3 * edgesCount + 7) / 8);
+        record.edgeTypes.resize(edgesCount);
+        for (size_t k = 0; k < edgesCount; ++k) {
+            size_t bit = 3 * k;
+            uint32_t bits = mData[mPos + bit / 8];
+            if (bit % 8 > 5) bits |= (uint32_t) mData[mPos + bit / 8 + 1] << 8;
+            record.edgeTypes[k] = (MEDTester::EdgeType) ((bits >> (bit % 8)) & 7);
+        }
+        mPos += (3 * edgesCount + 7) / 8;
+    }
+
+    return true;
+}
+
+/* Assigns the types in the canonical order to both ends of each edge. */
+MEDTester::Decomposition MEDTester::ResultReader::getDecomposition(const MEDTester::FlatAdjList& adjList, const std::vector<MEDTester::EdgeType>& edgeTypes)
+{
+    int verticesCount = adjList.size() / 3;
+    MEDTester::Decomposition decomposition(verticesCount, std::vector<MEDTester::EdgeType>(3, MEDTester::EdgeType::NONE));
+
+    size_t k = 0;
+    for (int u = 0; u < verticesCount; ++u) {
+        for (int j = 0; j < 3; ++j) {
+            int v = adjList[3*u + j];
+            if (v < u || k >= edgeTypes.size()) continue;
+            decomposition[u][j] = edgeTypes[k];
+            for (int i = 0; i < 3; ++i) {
+                if (adjList[3*v + i] == u) decomposition[v][i] = edgeTypes[k];
+            }
+            ++k;
+        }
+    }
+
+    return decomposition;
+}
+
+
+uint32_t MEDTester::ResultReader::readUInt32()
+{
+    uint32_t x = (uint32_t) mData[mPos] | (uint32_t) mData[mPos + 1] << 8 | (uint32_t) mData[mPos + 2] << 16 | (uint32_t) mData[mPos + 3] << 24;
+    mPos += 4;
+    return x;
+}
+
+void MEDTester::ResultReader::require(size_t count) const
+{
+    if (mLength - mPos < count) throw WrongFormatException("truncated record at offset " + std::to_string(mPos) + ".");
+}
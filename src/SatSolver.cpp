@@ -1,59 +1,128 @@
 #include "SatSolver.h"
 
 #include "typedefs.h"
+#include "Encoding.h"
+#include "CanonicalForm.h"
 
-#include <cryptominisat5/cryptominisat.h>
+#ifdef SAT
+    #include <cryptominisat5/cryptominisat.h>
+#else
+    #include "CdclSolver.h"
+#endif
 
 #include <vector>
+#include <initializer_list>
 #include <utility>
 #include <numeric>
 #include <algorithm>
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
 
 
 #define EDGE_TYPES_COUNT 5
+#define COMPACT_VARS_COUNT 4
 
 
-void MEDTester::SatSolver::init()
-{
-    int n = mGraph.getVerticesCount();
-    MEDTester::Matrix adjList = mGraph.getAdjList();
+const unsigned int MEDTester::SatSolverPool::GRAPHS_PER_INSTANCE = 10000;
+const uint64_t MEDTester::SatSolver::SYMMETRY_BREAKING_CONFLICTS = 100;
+const size_t MEDTester::SatSolver::MAX_SYMMETRIES_COUNT = 8;
+const size_t MEDTester::SatSolver::MAX_LEX_LEADER_LENGTH = 30;
 
-    mDecompositionsCount = -1;
-    mCycleEquiv = false;
-    mNoNextDecomposition = false;
-    mEdgeVarNums = MEDTester::Matrix(n, MEDTester::MatrixLine(n, -1));
-    mEdgeVars = std::vector<std::pair<int,int>>();
 
-    int edgeVarNum = 0;
-    for (int u = 0; u < n; ++u) {
-        for (int i = 0; i < 3; ++i) {
-            int v = adjList[u][i];
-            if (mEdgeVarNums[v][u] != -1) {
-                mEdgeVarNums[u][v] = mEdgeVarNums[v][u];
-            } else {
-                mEdgeVarNums[u][v] = edgeVarNum;
-                mEdgeVars.push_back({u, v});
-                ++edgeVarNum;
-            }
+MEDTester::SatSolverPool::SatSolverPool(MEDTester::Encoding encoding, std::atomic<bool>* interrupt) : mEncoding(encoding), mInterrupt(interrupt) {}
+
+MEDTester::SatSolverPool::~SatSolverPool() {}
+
+/* Returns solver for graphs with given number of vertices. The solver contains only clauses that
+ * don't depend on edges of the graph (each edge has exactly one type and cycle equivalence variables
+ * in the one-hot encoding), every graph adds its own clauses guarded by an activation literal. Because retired clauses and
+ * learnt clauses pile up in the solver, it is replaced by a fresh one after a number of graphs. */
+MEDTester::SatBackend* MEDTester::SatSolverPool::acquire(int verticesCount)
+{
+    Instance& instance = mInstances[verticesCount];
+    if (!instance.solver || instance.graphsCount >= GRAPHS_PER_INSTANCE) {
+        int edgesCount = (3 * verticesCount) / 2;
+        instance.solver = std::make_unique<MEDTester::SatBackend>(nullptr, mInterrupt);
+        instance.graphsCount = 0;
+        if (mEncoding == MEDTester::Encoding::COMPACT) {
+            MEDTester::SatSolver::createCompactEdgeTheory(*instance.solver, edgesCount);
+        } else {
+            MEDTester::SatSolver::createEdgeTypeTheory(*instance.solver, edgesCount);
+            MEDTester::SatSolver::createCycleEquivTheory(*instance.solver, edgesCount);
         }
     }
+
+    ++instance.graphsCount;
+    return instance.solver.get();
+}
+
+MEDTester::Encoding MEDTester::SatSolverPool::getEncoding() const
+{
+    return mEncoding;
+}
+
+std::atomic<bool>* MEDTester::SatSolverPool::getInterrupt() const
+{
+    return mInterrupt;
 }
 
 
-MEDTester::SatSolver::SatSolver(const MEDTester::CubicGraph& graph) : mGraph(graph)
+void MEDTester::SatSolver::init(MEDTester::Encoding encoding)
 {
-    init();
+    mEncoding = encoding;
+    mVarsPerEdge = encoding == MEDTester::Encoding::COMPACT ? COMPACT_VARS_COUNT : EDGE_TYPES_COUNT;
+    mDecompositionsCount = -1;
+    mCycleEquiv = encoding == MEDTester::Encoding::COMPACT;     // It has the cycle variables already.
+    mNoNextDecomposition = false;
+    mInterrupted = false;
+    mInterrupt = nullptr;
+    mActivationVar = -1;
+    mSymmetryVar = -1;
+}
+
+
+MEDTester::SatSolver::SatSolver(const MEDTester::CubicGraph& graph, MEDTester::Encoding encoding) : mGraph(graph)
+{
+    init(encoding);
+    mOwnSolver = std::make_unique<MEDTester::SatBackend>();
+    mSolver = mOwnSolver.get();
     solve();
 }
 
-MEDTester::SatSolver::SatSolver(const MEDTester::CubicGraph& graph, unsigned int numThreads) : mGraph(graph)
+/* Solver of a portfolio - it can be run with more threads (only with cryptominisat) or with the
+ * other polarity to search a different part of the space first, and stopped by another thread. */
+MEDTester::SatSolver::SatSolver(const MEDTester::CubicGraph& graph, MEDTester::Encoding encoding, unsigned int numThreads, bool invertPolarity, std::atomic<bool>* interrupt) : mGraph(graph)
 {
-    init();
-    mSolver.set_num_threads(numThreads);
+    init(encoding);
+    mInterrupt = interrupt;
+    mOwnSolver = std::make_unique<MEDTester::SatBackend>(nullptr, interrupt);
+    mSolver = mOwnSolver.get();
+    mSolver->set_num_threads(numThreads);
+    if (invertPolarity) mSolver->set_default_polarity(!MEDTester::SAT_DEFAULT_POLARITY);
     solve();
 }
 
-MEDTester::SatSolver::~SatSolver() {}
+MEDTester::SatSolver::SatSolver(const MEDTester::CubicGraph& graph, MEDTester::SatSolverPool& pool) : mGraph(graph)
+{
+    init(pool.getEncoding());
+    mSolver = pool.acquire(graph.getVerticesCount());
+    mInterrupt = pool.getInterrupt();
+    mCycleEquiv = true;
+    mActivationVar = mSolver->nVars();
+    mSolver->new_var();
+    solve();
+}
+
+/* Clauses of the graph in a shared solver are switched off for good by the negated activation
+ * literal, so the solver can throw them away during simplification. */
+MEDTester::SatSolver::~SatSolver()
+{
+    if (mActivationVar != -1) {
+        mSolver->add_clause({MEDTester::SatLit(mActivationVar, true)});
+    }
+}
 
 
 bool MEDTester::SatSolver::isDecomposable() const
@@ -61,11 +130,21 @@ bool MEDTester::SatSolver::isDecomposable() const
     return mDecomposable;
 }
 
+bool MEDTester::SatSolver::isInterrupted() const
+{
+    return mInterrupted;
+}
+
 MEDTester::Decomposition MEDTester::SatSolver::getDecomposition() const
 {
     return mDecomposition;
 }
 
+const MEDTester::SatSolver::Stats& MEDTester::SatSolver::getStats() const
+{
+    return mStats;
+}
+
 
 bool MEDTester::SatSolver::solveNext(bool overwrite)
 {
@@ -77,54 +156,52 @@ bool MEDTester::SatSolver::solveNext(bool overwrite)
     };
 
     if (!mCycleEquiv) {
-        mSolver.new_vars(edgesCount);
-        for (int e = 0; e < edgesCount; ++e) {
-            int cycleVar = isCycleEdgeVar(e);
-            int evenVar = e * EDGE_TYPES_COUNT + (int) MEDTester::SatEdgeType::CYCLE_EVEN;
-            int oddVar = e * EDGE_TYPES_COUNT + (int) MEDTester::SatEdgeType::CYCLE_ODD;
-            mSolver.add_clause({CMSat::Lit(cycleVar, true), CMSat::Lit(evenVar, false), CMSat::Lit(oddVar, false)});
-            mSolver.add_clause({CMSat::Lit(cycleVar, false), CMSat::Lit(evenVar, true)});
-            mSolver.add_clause({CMSat::Lit(cycleVar, false), CMSat::Lit(oddVar, true)});
-        }
+        createCycleEquivTheory(*mSolver, edgesCount);
         mCycleEquiv = true;
     }
 
-    std::vector<CMSat::lbool> model = mSolver.get_model();
+    std::vector<MEDTester::SatValue> model = mSolver->get_model();
     MEDTester::Clause clause;
-    for (int e = 0; e < edgesCount; ++e) {
-        int eVar = e * EDGE_TYPES_COUNT;
-        for (int t = 0; t < EDGE_TYPES_COUNT; ++t) {
-            if (model[eVar + t] == CMSat::l_True) {
-                if (t == (int) MEDTester::SatEdgeType::CYCLE_EVEN || t == (int) MEDTester::SatEdgeType::CYCLE_ODD) {
-                    clause.push_back(CMSat::Lit(isCycleEdgeVar(e), true));
-                } else {
-                    clause.push_back(CMSat::Lit(eVar + t, true));
-                }
+    if (mEncoding == MEDTester::Encoding::COMPACT) {
+        /* Each edge is blocked by its type, matching edge by the absence of the other types. */
+        for (int e = 0; e < edgesCount; ++e) {
+            int eVar = e * COMPACT_VARS_COUNT;
+            switch (getEdgeType(model, e)) {
+            case MEDTester::EdgeType::CYCLE:
+                clause.push_back(MEDTester::SatLit(eVar + (int) MEDTester::CompactVar::CYCLE, true));
+                break;
+            case MEDTester::EdgeType::STAR_CENTER:
+                clause.push_back(MEDTester::SatLit(eVar + (int) MEDTester::CompactVar::STAR_CENTER, true));
+                break;
+            case MEDTester::EdgeType::STAR_LEAF:
+                clause.push_back(MEDTester::SatLit(eVar + (int) MEDTester::CompactVar::STAR_LEAF, true));
+                break;
+            default:
+                clause.push_back(MEDTester::SatLit(eVar + (int) MEDTester::CompactVar::CYCLE, false));
+                clause.push_back(MEDTester::SatLit(eVar + (int) MEDTester::CompactVar::STAR_CENTER, false));
+                clause.push_back(MEDTester::SatLit(eVar + (int) MEDTester::CompactVar::STAR_LEAF, false));
                 break;
             }
         }
-    }
-    mSolver.add_clause(clause);
-    mNoNextDecomposition = mSolver.solve() == CMSat::l_True ? false : true;
-
-    if (overwrite) {
-        model = mSolver.get_model();
-        MEDTester::Matrix adjListIndices = mGraph.getAdjListIndices();
+    } else {
         for (int e = 0; e < edgesCount; ++e) {
             int eVar = e * EDGE_TYPES_COUNT;
             for (int t = 0; t < EDGE_TYPES_COUNT; ++t) {
-                if (model[eVar + t] == CMSat::l_True) {
-                    std::pair<std::pair<int,int>, MEDTester::SatEdgeType> edgeVar = edgeVarFromNum(eVar + t);
-                    int u = edgeVar.first.first;
-                    int v = edgeVar.first.second;
-                    MEDTester::EdgeType type = set2et(edgeVar.second);
-                    mDecomposition[u][adjListIndices[u][v]] = type;
-                    mDecomposition[v][adjListIndices[v][u]] = type;
+                if (model[eVar + t] == MEDTester::SAT_TRUE) {
+                    if (t == (int) MEDTester::SatEdgeType::CYCLE_EVEN || t == (int) MEDTester::SatEdgeType::CYCLE_ODD) {
+                        clause.push_back(MEDTester::SatLit(isCycleEdgeVar(e), true));
+                    } else {
+                        clause.push_back(MEDTester::SatLit(eVar + t, true));
+                    }
                     break;
                 }
             }
         }
     }
+    addClause(clause);
+    mNoNextDecomposition = solveWithActivation(false) == MEDTester::SAT_TRUE ? false : true;
+
+    if (overwrite && !mNoNextDecomposition) readDecomposition();
 
     return !mNoNextDecomposition;
 }
@@ -143,18 +220,32 @@ int MEDTester::SatSolver::getDecompositionsCount()
 }
 
 
-int MEDTester::SatSolver::edgeVarToNum(int v1, int v2, MEDTester::SatEdgeType type) const
+int MEDTester::SatSolver::edgeVarToNum(int vertex, int index, MEDTester::SatEdgeType type) const
 {
-    if (v1 < 0 || v2 < 0 || v1 >= mGraph.getVerticesCount() || v2 >= mGraph.getVerticesCount()) return -1;
-    return mEdgeVarNums[v1][v2] * EDGE_TYPES_COUNT + (int) type;
+    if (vertex < 0 || vertex >= mGraph.getVerticesCount() || index < 0 || index >= 3) return -1;
+    return mGraph.getEdgeId(vertex, index) * EDGE_TYPES_COUNT + (int) type;
 }
 
-std::pair<std::pair<int,int>, MEDTester::SatEdgeType> MEDTester::SatSolver::edgeVarFromNum(int var) const
+MEDTester::SatLit MEDTester::SatSolver::compactLit(int vertex, int index, MEDTester::CompactVar var, bool isInverted) const
 {
-    if (var >= mGraph.getEdgesCount() * EDGE_TYPES_COUNT) return {};
-    MEDTester::SatEdgeType type = (MEDTester::SatEdgeType) (var % EDGE_TYPES_COUNT);
-    std::pair<int,int> edge = mEdgeVars[var / EDGE_TYPES_COUNT];
-    return {edge, type};
+    return MEDTester::SatLit(mGraph.getEdgeId(vertex, index) * COMPACT_VARS_COUNT + (int) var, isInverted);
+}
+
+MEDTester::EdgeType MEDTester::SatSolver::getEdgeType(const std::vector<MEDTester::SatValue>& model, int edge) const
+{
+    if (mEncoding == MEDTester::Encoding::COMPACT) {
+        int eVar = edge * COMPACT_VARS_COUNT;
+        if (model[eVar + (int) MEDTester::CompactVar::CYCLE] == MEDTester::SAT_TRUE) return MEDTester::EdgeType::CYCLE;
+        if (model[eVar + (int) MEDTester::CompactVar::STAR_CENTER] == MEDTester::SAT_TRUE) return MEDTester::EdgeType::STAR_CENTER;
+        if (model[eVar + (int) MEDTester::CompactVar::STAR_LEAF] == MEDTester::SAT_TRUE) return MEDTester::EdgeType::STAR_LEAF;
+        return MEDTester::EdgeType::MATCHING;
+    }
+
+    int eVar = edge * EDGE_TYPES_COUNT;
+    for (int t = 0; t < EDGE_TYPES_COUNT; ++t) {
+        if (model[eVar + t] == MEDTester::SAT_TRUE) return set2et((MEDTester::SatEdgeType) t);
+    }
+    return MEDTester::EdgeType::NONE;
 }
 
 MEDTester::EdgeType MEDTester::SatSolver::set2et(MEDTester::SatEdgeType type) const
@@ -176,152 +267,245 @@ MEDTester::EdgeType MEDTester::SatSolver::set2et(MEDTester::SatEdgeType type) co
 }
 
 
-void MEDTester::SatSolver::createTheory()
+void MEDTester::SatSolver::createEdgeTypeTheory(MEDTester::SatBackend& solver, int edgesCount)
 {
-    int verticesCount = mGraph.getVerticesCount();
-    int edgesCount = mGraph.getEdgesCount();
-    MEDTester::Matrix adjList = mGraph.getAdjList();
-    MEDTester::Matrix adjListIndices = mGraph.getAdjListIndices();
-
     /* Var e(uv,T) for each edge uv and each edge type T. If e(uv,T) is set to true, it means
      * edge uv is of type T. */
-    mSolver.new_vars(edgesCount * EDGE_TYPES_COUNT);
+    solver.new_vars(edgesCount * EDGE_TYPES_COUNT);
 
     /* Each edge should have only one edge type, which can be made using following clauses. */
     for (int e = 0; e < edgesCount; ++e) {
         /* Each edge must have at least one type. */
         MEDTester::Clause clause;
         for (int t = 0; t < EDGE_TYPES_COUNT; ++t) {
-            clause.push_back(CMSat::Lit(e * EDGE_TYPES_COUNT + t, false));
+            clause.push_back(MEDTester::SatLit(e * EDGE_TYPES_COUNT + t, false));
         }
-        mSolver.add_clause(clause);
+        solver.add_clause(clause);
 
         /* Each edge can't have more than one type. */
         for (int t1 = 0; t1 < EDGE_TYPES_COUNT - 1; ++t1) {
             for (int t2 = t1 + 1; t2 < EDGE_TYPES_COUNT; ++t2) {
-                mSolver.add_clause({CMSat::Lit(e * EDGE_TYPES_COUNT + t1, true), CMSat::Lit(e * EDGE_TYPES_COUNT + t2, true)});
+                solver.add_clause({MEDTester::SatLit(e * EDGE_TYPES_COUNT + t1, true), MEDTester::SatLit(e * EDGE_TYPES_COUNT + t2, true)});
             }
         }
     }
+}
+
+/* Var c(uv) for each edge uv (numbered after all variables e(uv,T)), which is true if and only if
+ * edge uv is a cycle edge (no matter if "even" or "odd"). Used for blocking already found
+ * decompositions. */
+void MEDTester::SatSolver::createCycleEquivTheory(MEDTester::SatBackend& solver, int edgesCount)
+{
+    solver.new_vars(edgesCount);
+    for (int e = 0; e < edgesCount; ++e) {
+        int cycleVar = edgesCount * EDGE_TYPES_COUNT + e;
+        int evenVar = e * EDGE_TYPES_COUNT + (int) MEDTester::SatEdgeType::CYCLE_EVEN;
+        int oddVar = e * EDGE_TYPES_COUNT + (int) MEDTester::SatEdgeType::CYCLE_ODD;
+        solver.add_clause({MEDTester::SatLit(cycleVar, true), MEDTester::SatLit(evenVar, false), MEDTester::SatLit(oddVar, false)});
+        solver.add_clause({MEDTester::SatLit(cycleVar, false), MEDTester::SatLit(evenVar, true)});
+        solver.add_clause({MEDTester::SatLit(cycleVar, false), MEDTester::SatLit(oddVar, true)});
+    }
+}
+
+/* Compact encoding has vars c(uv), s(uv) and l(uv) for cycle, double-star center and double-star
+ * leaf edges and p(uv) for the parity of a cycle edge, matching edge has none of the first three
+ * set. Parity of the other edges is false, so that the solver doesn't branch on it. */
+void MEDTester::SatSolver::createCompactEdgeTheory(MEDTester::SatBackend& solver, int edgesCount)
+{
+    solver.new_vars(edgesCount * COMPACT_VARS_COUNT);
+    for (int e = 0; e < edgesCount; ++e) {
+        MEDTester::SatLit cycleLit(e * COMPACT_VARS_COUNT + (int) MEDTester::CompactVar::CYCLE, true);
+        MEDTester::SatLit starCenterLit(e * COMPACT_VARS_COUNT + (int) MEDTester::CompactVar::STAR_CENTER, true);
+        MEDTester::SatLit starLeafLit(e * COMPACT_VARS_COUNT + (int) MEDTester::CompactVar::STAR_LEAF, true);
+        solver.add_clause({cycleLit, starCenterLit});
+        solver.add_clause({cycleLit, starLeafLit});
+        solver.add_clause({starCenterLit, starLeafLit});
+        solver.add_clause({~cycleLit, MEDTester::SatLit(e * COMPACT_VARS_COUNT + (int) MEDTester::CompactVar::PARITY, true)});
+    }
+}
+
+/* Clauses are copied into one buffer (together with the activation literal), so adding them
+ * doesn't allocate memory once the buffer is large enough. */
+void MEDTester::SatSolver::addClause(const MEDTester::Clause& clause)
+{
+    mClause.assign(clause.begin(), clause.end());
+    if (mActivationVar != -1) {
+        mClause.push_back(MEDTester::SatLit(mActivationVar, true));
+    }
+    mSolver->add_clause(mClause);
+}
+
+void MEDTester::SatSolver::addClause(std::initializer_list<MEDTester::SatLit> lits)
+{
+    mClause.assign(lits.begin(), lits.end());
+    if (mActivationVar != -1) {
+        mClause.push_back(MEDTester::SatLit(mActivationVar, true));
+    }
+    mSolver->add_clause(mClause);
+}
+
+/* Statistics of a shared solver are summed over all its graphs, so only their increase is counted.
+ * Symmetry breaking clauses are used only for the first solution, enumeration of all decompositions
+ * needs the symmetric ones too. The interrupt flag is checked before solving too, cryptominisat
+ * clears it when a solve call starts. */
+MEDTester::SatValue MEDTester::SatSolver::solveWithActivation(bool breakSymmetries)
+{
+    if (mInterrupt && mInterrupt->load()) return MEDTester::SAT_UNDEF;
+
+    uint64_t conflicts = mSolver->get_sum_conflicts();
+    uint64_t decisions = mSolver->get_sum_decisions();
+    uint64_t propagations = mSolver->get_sum_propagations();
+    auto timeStart = std::chrono::steady_clock::now();
+
+    std::vector<MEDTester::SatLit> assumptions;
+    if (mActivationVar != -1) assumptions.push_back(MEDTester::SatLit(mActivationVar, false));
+    if (mSymmetryVar != -1) assumptions.push_back(MEDTester::SatLit(mSymmetryVar, !breakSymmetries));
+
+    MEDTester::SatValue result = assumptions.empty() ? mSolver->solve() : mSolver->solve(&assumptions);
+
+    mStats.solveNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - timeStart).count();
+    mStats.conflicts += mSolver->get_sum_conflicts() - conflicts;
+    mStats.decisions += mSolver->get_sum_decisions() - decisions;
+    mStats.propagations += mSolver->get_sum_propagations() - propagations;
+    return result;
+}
+
+
+void MEDTester::SatSolver::createTheory()
+{
+    if (mEncoding == MEDTester::Encoding::COMPACT) {
+        createCompactTheory();
+    } else {
+        createOneHotTheory();
+    }
+}
+
+void MEDTester::SatSolver::createOneHotTheory()
+{
+    int verticesCount = mGraph.getVerticesCount();
+    int edgesCount = mGraph.getEdgesCount();
+
+    /* Clauses not depending on edges of the graph are already in a shared solver. */
+    if (mActivationVar == -1) {
+        createEdgeTypeTheory(*mSolver, edgesCount);
+    }
 
     for (int v = 0; v < verticesCount; ++v) {
         /* Adjacent edges can't be both matching edges. */
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][0], MEDTester::SatEdgeType::MATCHING), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][1], MEDTester::SatEdgeType::MATCHING), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 0, MEDTester::SatEdgeType::MATCHING), true),
+            MEDTester::SatLit(edgeVarToNum(v, 1, MEDTester::SatEdgeType::MATCHING), true)
         });
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][0], MEDTester::SatEdgeType::MATCHING), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][2], MEDTester::SatEdgeType::MATCHING), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 0, MEDTester::SatEdgeType::MATCHING), true),
+            MEDTester::SatLit(edgeVarToNum(v, 2, MEDTester::SatEdgeType::MATCHING), true)
         });
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][1], MEDTester::SatEdgeType::MATCHING), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][2], MEDTester::SatEdgeType::MATCHING), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 1, MEDTester::SatEdgeType::MATCHING), true),
+            MEDTester::SatLit(edgeVarToNum(v, 2, MEDTester::SatEdgeType::MATCHING), true)
         });
 
         /* Adjacent edges can't be both cycle edges with same "parity". */
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][0], MEDTester::SatEdgeType::CYCLE_EVEN), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][1], MEDTester::SatEdgeType::CYCLE_EVEN), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 0, MEDTester::SatEdgeType::CYCLE_EVEN), true),
+            MEDTester::SatLit(edgeVarToNum(v, 1, MEDTester::SatEdgeType::CYCLE_EVEN), true)
         });
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][0], MEDTester::SatEdgeType::CYCLE_EVEN), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][2], MEDTester::SatEdgeType::CYCLE_EVEN), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 0, MEDTester::SatEdgeType::CYCLE_EVEN), true),
+            MEDTester::SatLit(edgeVarToNum(v, 2, MEDTester::SatEdgeType::CYCLE_EVEN), true)
         });
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][1], MEDTester::SatEdgeType::CYCLE_EVEN), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][2], MEDTester::SatEdgeType::CYCLE_EVEN), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 1, MEDTester::SatEdgeType::CYCLE_EVEN), true),
+            MEDTester::SatLit(edgeVarToNum(v, 2, MEDTester::SatEdgeType::CYCLE_EVEN), true)
         });
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][0], MEDTester::SatEdgeType::CYCLE_ODD), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][1], MEDTester::SatEdgeType::CYCLE_ODD), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 0, MEDTester::SatEdgeType::CYCLE_ODD), true),
+            MEDTester::SatLit(edgeVarToNum(v, 1, MEDTester::SatEdgeType::CYCLE_ODD), true)
         });
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][0], MEDTester::SatEdgeType::CYCLE_ODD), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][2], MEDTester::SatEdgeType::CYCLE_ODD), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 0, MEDTester::SatEdgeType::CYCLE_ODD), true),
+            MEDTester::SatLit(edgeVarToNum(v, 2, MEDTester::SatEdgeType::CYCLE_ODD), true)
         });
-        mSolver.add_clause({
-            CMSat::Lit(edgeVarToNum(v, adjList[v][1], MEDTester::SatEdgeType::CYCLE_ODD), true),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][2], MEDTester::SatEdgeType::CYCLE_ODD), true)
+        addClause({
+            MEDTester::SatLit(edgeVarToNum(v, 1, MEDTester::SatEdgeType::CYCLE_ODD), true),
+            MEDTester::SatLit(edgeVarToNum(v, 2, MEDTester::SatEdgeType::CYCLE_ODD), true)
         });
     }
 
     for (int e = 0; e < edgesCount; ++e) {
-        int u = mEdgeVars[e].first;
-        int v = mEdgeVars[e].second;
-        int i = adjListIndices[u][v];
-        int j = adjListIndices[v][u];
+        int u = mGraph.getEdgeSlot(e).first;
+        int i = mGraph.getEdgeSlot(e).second;
+        int v = mGraph.getNeighbour(u, i);
+        int j = mGraph.getReverseIndex(u, i);
 
         /* Each "odd" cycle edge has exactly one adjacent "even" edge on each side and vice versa.
          * In other words, if an edge is cycle even edge, than it has two adjacent cycle odd edges
          * and vice versa (but those edges can't be adjacent with each other because of previoulys
          * added clauses). */
-        CMSat::Lit cycleEvenLit(edgeVarToNum(u, v, MEDTester::SatEdgeType::CYCLE_EVEN), true);
-        CMSat::Lit cycleOddLit(edgeVarToNum(u, v, MEDTester::SatEdgeType::CYCLE_ODD), true);
+        MEDTester::SatLit cycleEvenLit(edgeVarToNum(u, i, MEDTester::SatEdgeType::CYCLE_EVEN), true);
+        MEDTester::SatLit cycleOddLit(edgeVarToNum(u, i, MEDTester::SatEdgeType::CYCLE_ODD), true);
 
-        mSolver.add_clause({
+        addClause({
             cycleEvenLit,
-            CMSat::Lit(edgeVarToNum(u, adjList[u][(i+1)%3], MEDTester::SatEdgeType::CYCLE_ODD), false),
-            CMSat::Lit(edgeVarToNum(u, adjList[u][(i+2)%3], MEDTester::SatEdgeType::CYCLE_ODD), false)
+            MEDTester::SatLit(edgeVarToNum(u, (i+1)%3, MEDTester::SatEdgeType::CYCLE_ODD), false),
+            MEDTester::SatLit(edgeVarToNum(u, (i+2)%3, MEDTester::SatEdgeType::CYCLE_ODD), false)
         });
-        mSolver.add_clause({
+        addClause({
             cycleEvenLit,
-            CMSat::Lit(edgeVarToNum(v, adjList[v][(j+1)%3], MEDTester::SatEdgeType::CYCLE_ODD), false),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][(j+2)%3], MEDTester::SatEdgeType::CYCLE_ODD), false)
+            MEDTester::SatLit(edgeVarToNum(v, (j+1)%3, MEDTester::SatEdgeType::CYCLE_ODD), false),
+            MEDTester::SatLit(edgeVarToNum(v, (j+2)%3, MEDTester::SatEdgeType::CYCLE_ODD), false)
         });
         
-        mSolver.add_clause({
+        addClause({
             cycleOddLit,
-            CMSat::Lit(edgeVarToNum(u, adjList[u][(i+1)%3], MEDTester::SatEdgeType::CYCLE_EVEN), false),
-            CMSat::Lit(edgeVarToNum(u, adjList[u][(i+2)%3], MEDTester::SatEdgeType::CYCLE_EVEN), false)
+            MEDTester::SatLit(edgeVarToNum(u, (i+1)%3, MEDTester::SatEdgeType::CYCLE_EVEN), false),
+            MEDTester::SatLit(edgeVarToNum(u, (i+2)%3, MEDTester::SatEdgeType::CYCLE_EVEN), false)
         });
-        mSolver.add_clause({
+        addClause({
             cycleOddLit,
-            CMSat::Lit(edgeVarToNum(v, adjList[v][(j+1)%3], MEDTester::SatEdgeType::CYCLE_EVEN), false),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][(j+2)%3], MEDTester::SatEdgeType::CYCLE_EVEN), false)
+            MEDTester::SatLit(edgeVarToNum(v, (j+1)%3, MEDTester::SatEdgeType::CYCLE_EVEN), false),
+            MEDTester::SatLit(edgeVarToNum(v, (j+2)%3, MEDTester::SatEdgeType::CYCLE_EVEN), false)
         });
 
         /* Double-star center edge should be adjacent to only Double-star leaf edges. */
-        CMSat::Lit starCenterLit(edgeVarToNum(u, v, MEDTester::SatEdgeType::STAR_CENTER), true);
+        MEDTester::SatLit starCenterLit(edgeVarToNum(u, i, MEDTester::SatEdgeType::STAR_CENTER), true);
 
-        mSolver.add_clause({starCenterLit, CMSat::Lit(edgeVarToNum(u, adjList[u][(i+1)%3], MEDTester::SatEdgeType::STAR_LEAF), false)});
-        mSolver.add_clause({starCenterLit, CMSat::Lit(edgeVarToNum(u, adjList[u][(i+2)%3], MEDTester::SatEdgeType::STAR_LEAF), false)});
-        mSolver.add_clause({starCenterLit, CMSat::Lit(edgeVarToNum(v, adjList[v][(j+1)%3], MEDTester::SatEdgeType::STAR_LEAF), false)});
-        mSolver.add_clause({starCenterLit, CMSat::Lit(edgeVarToNum(v, adjList[v][(j+2)%3], MEDTester::SatEdgeType::STAR_LEAF), false)});
+        addClause({starCenterLit, MEDTester::SatLit(edgeVarToNum(u, (i+1)%3, MEDTester::SatEdgeType::STAR_LEAF), false)});
+        addClause({starCenterLit, MEDTester::SatLit(edgeVarToNum(u, (i+2)%3, MEDTester::SatEdgeType::STAR_LEAF), false)});
+        addClause({starCenterLit, MEDTester::SatLit(edgeVarToNum(v, (j+1)%3, MEDTester::SatEdgeType::STAR_LEAF), false)});
+        addClause({starCenterLit, MEDTester::SatLit(edgeVarToNum(v, (j+2)%3, MEDTester::SatEdgeType::STAR_LEAF), false)});
 
         /* Each double-star leaf edge should have one adjacent double-star center edge and
          * one adjacent cycle edge (both even and odd cycle edge, but that is assured in previous
          * clauses). We don't need to add clauses telling that those two edges can't be adjacent,
          * because that is implied by other clauses. */
-        CMSat::Lit starLeafLit(edgeVarToNum(u, v, MEDTester::SatEdgeType::STAR_LEAF), true);
+        MEDTester::SatLit starLeafLit(edgeVarToNum(u, i, MEDTester::SatEdgeType::STAR_LEAF), true);
 
-        mSolver.add_clause({
+        addClause({
             starLeafLit,
-            CMSat::Lit(edgeVarToNum(u, adjList[u][(i+1)%3], MEDTester::SatEdgeType::STAR_CENTER), false),
-            CMSat::Lit(edgeVarToNum(u, adjList[u][(i+2)%3], MEDTester::SatEdgeType::STAR_CENTER), false),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][(j+1)%3], MEDTester::SatEdgeType::STAR_CENTER), false),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][(j+2)%3], MEDTester::SatEdgeType::STAR_CENTER), false)
+            MEDTester::SatLit(edgeVarToNum(u, (i+1)%3, MEDTester::SatEdgeType::STAR_CENTER), false),
+            MEDTester::SatLit(edgeVarToNum(u, (i+2)%3, MEDTester::SatEdgeType::STAR_CENTER), false),
+            MEDTester::SatLit(edgeVarToNum(v, (j+1)%3, MEDTester::SatEdgeType::STAR_CENTER), false),
+            MEDTester::SatLit(edgeVarToNum(v, (j+2)%3, MEDTester::SatEdgeType::STAR_CENTER), false)
         });
 
-        mSolver.add_clause({
+        addClause({
             starLeafLit,
-            CMSat::Lit(edgeVarToNum(u, adjList[u][(i+1)%3], MEDTester::SatEdgeType::CYCLE_EVEN), false),
-            CMSat::Lit(edgeVarToNum(u, adjList[u][(i+2)%3], MEDTester::SatEdgeType::CYCLE_EVEN), false),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][(j+1)%3], MEDTester::SatEdgeType::CYCLE_EVEN), false),
-            CMSat::Lit(edgeVarToNum(v, adjList[v][(j+2)%3], MEDTester::SatEdgeType::CYCLE_EVEN), false)
+            MEDTester::SatLit(edgeVarToNum(u, (i+1)%3, MEDTester::SatEdgeType::CYCLE_EVEN), false),
+            MEDTester::SatLit(edgeVarToNum(u, (i+2)%3, MEDTester::SatEdgeType::CYCLE_EVEN), false),
+            MEDTester::SatLit(edgeVarToNum(v, (j+1)%3, MEDTester::SatEdgeType::CYCLE_EVEN), false),
+            MEDTester::SatLit(edgeVarToNum(v, (j+2)%3, MEDTester::SatEdgeType::CYCLE_EVEN), false)
         });
 
         /* Double-stars should be indenpendent - for each edge, he shouldn't have more than one 
          * adjacent double-star leaf edge unless it is double-star center. */
-        CMSat::Lit starCenterLit2(edgeVarToNum(u, v, MEDTester::SatEdgeType::STAR_CENTER), false);
+        MEDTester::SatLit starCenterLit2(edgeVarToNum(u, i, MEDTester::SatEdgeType::STAR_CENTER), false);
         for (int a = 1; a <= 2; ++a) {
             for (int b = 1; b <= 2; ++b) {
-                int x = adjList[u][(i+a)%3];
-                int y = adjList[v][(j+b)%3];
-                mSolver.add_clause({
+                addClause({
                     starCenterLit2,
-                    CMSat::Lit(edgeVarToNum(u, x, MEDTester::SatEdgeType::STAR_LEAF), true),
-                    CMSat::Lit(edgeVarToNum(v, y, MEDTester::SatEdgeType::STAR_LEAF), true),
+                    MEDTester::SatLit(edgeVarToNum(u, (i+a)%3, MEDTester::SatEdgeType::STAR_LEAF), true),
+                    MEDTester::SatLit(edgeVarToNum(v, (j+b)%3, MEDTester::SatEdgeType::STAR_LEAF), true),
                 });
             }
         }
@@ -329,31 +513,257 @@ void MEDTester::SatSolver::createTheory()
 }
 
 
-void MEDTester::SatSolver::solve()
+/* The one-hot clauses allow only vertices with two cycle edges of different parity and a matching
+ * or a double-star leaf edge, or with a double-star center edge and two leaf edges. Compact encoding
+ * states this directly at each vertex, so it needs far fewer clauses per graph. */
+void MEDTester::SatSolver::createCompactTheory()
 {
-    // mSolver.log_to_file("sat.log");
-    createTheory();
-    mDecomposable = mSolver.solve() == CMSat::l_True ? true : false;
-    
-    if (mDecomposable) {
-        mDecomposition = MEDTester::Decomposition(mGraph.getVerticesCount(), std::vector<MEDTester::EdgeType>(3, MEDTester::EdgeType::NONE));
-        std::vector<CMSat::lbool> model = mSolver.get_model();
-        MEDTester::Matrix adjListIndices = mGraph.getAdjListIndices();
+    int verticesCount = mGraph.getVerticesCount();
+    int edgesCount = mGraph.getEdgesCount();
 
-        for (int e = 0; e < mGraph.getEdgesCount(); ++e) {
-            for (int t = 0; t < EDGE_TYPES_COUNT; ++t) {
-                int eVar = e * EDGE_TYPES_COUNT;
-                if (model[eVar + t] == CMSat::l_True) {
-                    std::pair<std::pair<int,int>, MEDTester::SatEdgeType> edgeVar = edgeVarFromNum(eVar + t);
-                    int u = edgeVar.first.first;
-                    int v = edgeVar.first.second;
-                    MEDTester::EdgeType type = set2et(edgeVar.second);
-                    mDecomposition[u][adjListIndices[u][v]] = type;
-                    mDecomposition[v][adjListIndices[v][u]] = type;
-                    break;
+    /* Clauses not depending on edges of the graph are already in a shared solver. */
+    if (mActivationVar == -1) {
+        createCompactEdgeTheory(*mSolver, edgesCount);
+    }
+
+    MEDTester::Clause clause;
+    for (int v = 0; v < verticesCount; ++v) {
+        /* Each vertex has an even number of cycle edges, but not all three. */
+        for (int inverted = 0; inverted < 4; ++inverted) {
+            clause.clear();
+            for (int i = 0; i < 3; ++i) {
+                bool isInverted = inverted == 0 || inverted == i + 1;
+                clause.push_back(compactLit(v, i, MEDTester::CompactVar::CYCLE, isInverted));
+            }
+            addClause(clause);
+        }
+
+        /* Two cycle edges at the vertex have different parity. */
+        for (int i = 0; i < 2; ++i) {
+            for (int k = i + 1; k < 3; ++k) {
+                for (bool isInverted : {false, true}) {
+                    addClause({
+                        compactLit(v, i, MEDTester::CompactVar::CYCLE, true),
+                        compactLit(v, k, MEDTester::CompactVar::CYCLE, true),
+                        compactLit(v, i, MEDTester::CompactVar::PARITY, isInverted),
+                        compactLit(v, k, MEDTester::CompactVar::PARITY, isInverted)
+                    });
                 }
             }
         }
+
+        /* Vertex without cycle edges is an end of a double-star center edge, whose other edges are
+         * double-star leaf edges. */
+        addClause({
+            compactLit(v, 0, MEDTester::CompactVar::CYCLE, false),
+            compactLit(v, 1, MEDTester::CompactVar::CYCLE, false),
+            compactLit(v, 0, MEDTester::CompactVar::STAR_CENTER, false),
+            compactLit(v, 1, MEDTester::CompactVar::STAR_CENTER, false),
+            compactLit(v, 2, MEDTester::CompactVar::STAR_CENTER, false)
+        });
+        for (int i = 0; i < 3; ++i) {
+            addClause({compactLit(v, i, MEDTester::CompactVar::STAR_CENTER, true), compactLit(v, (i+1)%3, MEDTester::CompactVar::STAR_LEAF, false)});
+            addClause({compactLit(v, i, MEDTester::CompactVar::STAR_CENTER, true), compactLit(v, (i+2)%3, MEDTester::CompactVar::STAR_LEAF, false)});
+        }
+    }
+
+    for (int e = 0; e < edgesCount; ++e) {
+        int u = mGraph.getEdgeSlot(e).first;
+        int i = mGraph.getEdgeSlot(e).second;
+        int v = mGraph.getNeighbour(u, i);
+        int j = mGraph.getReverseIndex(u, i);
+
+        /* Double-star leaf edge joins a vertex of a cycle with a vertex without cycle edges (the
+         * number of cycle edges at a vertex is known from one of the other two edges). */
+        MEDTester::SatLit starLeafLit = compactLit(u, i, MEDTester::CompactVar::STAR_LEAF, true);
+        addClause({
+            starLeafLit,
+            compactLit(u, (i+1)%3, MEDTester::CompactVar::CYCLE, false),
+            compactLit(v, (j+1)%3, MEDTester::CompactVar::CYCLE, false)
+        });
+        addClause({
+            starLeafLit,
+            compactLit(u, (i+1)%3, MEDTester::CompactVar::CYCLE, true),
+            compactLit(v, (j+1)%3, MEDTester::CompactVar::CYCLE, true)
+        });
+
+        /* Double-stars should be independent, same as in the one-hot encoding. */
+        for (int a = 1; a <= 2; ++a) {
+            for (int b = 1; b <= 2; ++b) {
+                addClause({
+                    compactLit(u, i, MEDTester::CompactVar::STAR_CENTER, false),
+                    compactLit(u, (i+a)%3, MEDTester::CompactVar::STAR_LEAF, true),
+                    compactLit(v, (j+b)%3, MEDTester::CompactVar::STAR_LEAF, true)
+                });
+            }
+        }
+    }
+}
+
+void MEDTester::SatSolver::readDecomposition()
+{
+    mDecomposition = MEDTester::Decomposition(mGraph.getVerticesCount(), std::vector<MEDTester::EdgeType>(3, MEDTester::EdgeType::NONE));
+    std::vector<MEDTester::SatValue> model = mSolver->get_model();
+
+    for (int e = 0; e < mGraph.getEdgesCount(); ++e) {
+        std::pair<int,int> slot = mGraph.getEdgeSlot(e);
+        int v = mGraph.getNeighbour(slot.first, slot.second);
+        MEDTester::EdgeType type = getEdgeType(model, e);
+        mDecomposition[slot.first][slot.second] = type;
+        mDecomposition[v][mGraph.getReverseIndex(slot.first, slot.second)] = type;
+    }
+}
+
+
+/* Decompositions mapped by a symmetry of the graph are decompositions again, so it is enough to
+ * look for the lexicographically smallest one of each orbit (lex-leader). Symmetries used are the
+ * automorphisms found by the canonical labelling (it stops early on highly symmetric graphs, then
+ * only some of them are used) and the swap of even and odd cycle edges, which fixes the parity of
+ * the cycle with the first cycle edge (the compact encoding requires that edge to be even directly).
+ * Parities of the other cycles can be swapped independently,
+ * but which edges form a cycle is known only in the solution, so they are not broken. A shared
+ * solver is meant for many easy graphs and auxiliary variables of every graph would stay in it, so
+ * symmetries are broken only in an own solver. */
+void MEDTester::SatSolver::createSymmetryBreakingTheory()
+{
+    int edgesCount = mGraph.getEdgesCount();
+    if (edgesCount == 0 || mActivationVar != -1) return;
+
+    mSymmetryVar = mSolver->nVars();
+    mSolver->new_var();
+
+    std::vector<int> permutation(edgesCount * mVarsPerEdge);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    if (mEncoding == MEDTester::Encoding::COMPACT) {
+        addFirstCycleEdgeParity();
+    } else {
+        for (int e = 0; e < edgesCount; ++e) {
+            std::swap(permutation[e * EDGE_TYPES_COUNT + (int) MEDTester::SatEdgeType::CYCLE_EVEN],
+                      permutation[e * EDGE_TYPES_COUNT + (int) MEDTester::SatEdgeType::CYCLE_ODD]);
+        }
+        addLexLeader(permutation);
+    }
+
+    /* Edge uv is mapped to the edge between the images of u and v. Parallel edges would be mapped
+     * to the same edge, such automorphisms are skipped. */
+    MEDTester::CanonicalForm form(mGraph);
+    std::vector<int> edgeImages(edgesCount);
+    std::vector<bool> isImage(edgesCount);
+    size_t symmetriesCount = 0;
+    for (const std::vector<int>& automorphism : form.getAutomorphisms()) {
+        if (symmetriesCount >= MAX_SYMMETRIES_COUNT) break;
+        bool valid = true;
+        std::fill(isImage.begin(), isImage.end(), false);
+        for (int e = 0; e < edgesCount && valid; ++e) {
+            std::pair<int, int> slot = mGraph.getEdgeSlot(e);
+            int u = automorphism[slot.first];
+            int v = automorphism[mGraph.getNeighbour(slot.first, slot.second)];
+            int image = -1;
+            for (int k = 0; k < 3; ++k) {
+                if (mGraph.getNeighbour(u, k) == v) image = mGraph.getEdgeId(u, k);
+            }
+            valid = image != -1 && !isImage[image];
+            if (valid) {
+                isImage[image] = true;
+                edgeImages[e] = image;
+            }
+        }
+        if (!valid) continue;
+
+        for (int e = 0; e < edgesCount; ++e) {
+            for (int t = 0; t < mVarsPerEdge; ++t) permutation[e * mVarsPerEdge + t] = edgeImages[e] * mVarsPerEdge + t;
+        }
+        addLexLeader(permutation);
+        ++symmetriesCount;
+    }
+}
+
+/* Requires the assignment x to be lexicographically at most its image (x[permutation[0]], x[permutation[1]], ...)
+ * in the order of variables. Variable a(i) is true if the first i compared variables are equal to
+ * their images, only the first MAX_LEX_LEADER_LENGTH moved variables are compared. */
+void MEDTester::SatSolver::addLexLeader(const std::vector<int>& permutation)
+{
+    MEDTester::SatLit noSymmetry(mSymmetryVar, true);
+    std::vector<int> moved;
+    for (size_t x = 0; x < permutation.size() && moved.size() < MAX_LEX_LEADER_LENGTH; ++x) {
+        if (permutation[x] != (int) x) moved.push_back(x);
+    }
+
+    int equalVar = -1;
+    for (size_t k = 0; k < moved.size(); ++k) {
+        MEDTester::SatLit x(moved[k], false);
+        MEDTester::SatLit y(permutation[moved[k]], false);
+
+        MEDTester::Clause clause = {noSymmetry, ~x, y};
+        if (equalVar != -1) clause.push_back(MEDTester::SatLit(equalVar, true));
+        addClause(clause);
+        if (k + 1 == moved.size()) break;
+
+        int nextEqualVar = mSolver->nVars();
+        mSolver->new_var();
+        for (MEDTester::SatLit lit : {~x, y}) {
+            clause = {noSymmetry, lit, MEDTester::SatLit(nextEqualVar, false)};
+            if (equalVar != -1) clause.push_back(MEDTester::SatLit(equalVar, true));
+            addClause(clause);
+        }
+        equalVar = nextEqualVar;
+    }
+}
+
+/* Parity of the whole cycle can be swapped, so the first cycle edge (in the order of edges) can be
+ * required to be even. Variable b(uv) is true only if there is a cycle edge before edge uv. */
+void MEDTester::SatSolver::addFirstCycleEdgeParity()
+{
+    MEDTester::SatLit noSymmetry(mSymmetryVar, true);
+    int beforeVar = -1;
+    for (int e = 0; e < mGraph.getEdgesCount(); ++e) {
+        MEDTester::Clause clause = {
+            noSymmetry,
+            MEDTester::SatLit(e * COMPACT_VARS_COUNT + (int) MEDTester::CompactVar::CYCLE, true),
+            MEDTester::SatLit(e * COMPACT_VARS_COUNT + (int) MEDTester::CompactVar::PARITY, true)
+        };
+        if (beforeVar != -1) clause.push_back(MEDTester::SatLit(beforeVar, false));
+        addClause(clause);
+        if (e + 1 == mGraph.getEdgesCount()) break;
+
+        int nextBeforeVar = mSolver->nVars();
+        mSolver->new_var();
+        clause = {MEDTester::SatLit(nextBeforeVar, true), MEDTester::SatLit(e * COMPACT_VARS_COUNT + (int) MEDTester::CompactVar::CYCLE, false)};
+        if (beforeVar != -1) clause.push_back(MEDTester::SatLit(beforeVar, false));
+        addClause(clause);
+        beforeVar = nextBeforeVar;
+    }
+}
+
+void MEDTester::SatSolver::solve()
+{
+    // mSolver->log_to_file("sat.log");
+    auto timeStart = std::chrono::steady_clock::now();
+    createTheory();
+    mStats.theoryNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+    /* Most graphs are solved after a few conflicts, breaking of symmetries (and the search for
+     * automorphisms) pays off only for the hard ones. */
+    MEDTester::SatValue result;
+    if (mActivationVar == -1) {
+        mSolver->set_max_confl(SYMMETRY_BREAKING_CONFLICTS);
+        result = solveWithActivation(false);
+        mSolver->set_max_confl(UINT64_MAX);
+    } else {
+        result = solveWithActivation(false);
+    }
+
+    if (result == MEDTester::SAT_UNDEF && !(mInterrupt && mInterrupt->load())) {
+        timeStart = std::chrono::steady_clock::now();
+        createSymmetryBreakingTheory();
+        mStats.theoryNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - timeStart).count();
+        result = solveWithActivation(true);
+    }
+    mDecomposable = result == MEDTester::SAT_TRUE ? true : false;
+    mInterrupted = result == MEDTester::SAT_UNDEF;
+    
+    if (mDecomposable) {
+        readDecomposition();
     }
     else {
         mNoNextDecomposition = true;
@@ -0,0 +1,175 @@
+#include "TaitColoring.h"
+
+#include "CubicGraph.h"
+#include "typedefs.h"
+
+#include <vector>
+#include <cstdint>
+
+
+MEDTester::TaitColoring::TaitColoring(const MEDTester::CubicGraph& graph) : mGraph(graph)
+{
+    reset();
+}
+
+MEDTester::TaitColoring::~TaitColoring() {}
+
+/* The arrays keep their capacity, so the coloring of a graph reused for many graphs (see
+ * CubicGraph::assign) doesn't allocate memory once they are large enough. */
+void MEDTester::TaitColoring::reset()
+{
+    mColors.assign(mGraph.getEdgesCount(), -1);
+    mUsedColors.assign(mGraph.getVerticesCount(), 0);
+    mOrder.clear();
+    mTrail.clear();
+    mPending.clear();
+    mSearchDone = false;
+    mColorable = false;
+}
+
+
+MEDTester::Decomposition MEDTester::TaitColoring::getDecomposition()
+{
+    MEDTester::Decomposition decomposition;
+    getDecomposition(decomposition);
+    return decomposition;
+}
+
+void MEDTester::TaitColoring::getDecomposition(MEDTester::Decomposition& decomposition)
+{
+    int verticesCount = mGraph.getVerticesCount();
+    decomposition.resize(verticesCount);
+    for (std::vector<MEDTester::EdgeType>& types : decomposition) types.assign(3, MEDTester::EdgeType::NONE);
+    if (!isColorable()) return;
+
+    for (int v = 0; v < verticesCount; ++v) {
+        for (int i = 0; i < 3; ++i) {
+            int color = mColors[mGraph.getEdgeId(v, i)];
+            decomposition[v][i] = color == 0 ? MEDTester::EdgeType::MATCHING : MEDTester::EdgeType::CYCLE;
+        }
+    }
+}
+
+
+bool MEDTester::TaitColoring::isColorable()
+{
+    if (!mSearchDone) search();
+    return mColorable;
+}
+
+
+/* Edges are colored in BFS order, so every edge (except the first ones in each component) touches
+ * an already colored edge. Colors of the edges of the first vertex of each component can be fixed,
+ * because any coloring can be transformed to such one by a permutation of colors. */
+void MEDTester::TaitColoring::search()
+{
+    int verticesCount = mGraph.getVerticesCount();
+    std::vector<bool>& visited = mVisited;
+    std::vector<bool>& ordered = mOrdered;
+    std::vector<int>& queue = mQueue;
+    visited.assign(verticesCount, false);
+    ordered.assign(mGraph.getEdgesCount(), false);
+    queue.reserve(verticesCount);
+    mOrder.reserve(mGraph.getEdgesCount());
+    mTrail.reserve(mGraph.getEdgesCount());
+
+    mSearchDone = true;
+    mColorable = false;
+
+    for (int root = 0; root < verticesCount; ++root) {
+        if (visited[root]) continue;
+
+        if (!assignColor(mGraph.getEdgeId(root, 0), 0) || !assignColor(mGraph.getEdgeId(root, 1), 1)) return;
+
+        visited[root] = true;
+        queue.clear();
+        queue.push_back(root);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int v = queue[head];
+            for (int i = 0; i < 3; ++i) {
+                int e = mGraph.getEdgeId(v, i);
+                if (!ordered[e]) {
+                    ordered[e] = true;
+                    mOrder.push_back(e);
+                }
+                int w = mGraph.getNeighbour(v, i);
+                if (!visited[w]) {
+                    visited[w] = true;
+                    queue.push_back(w);
+                }
+            }
+        }
+    }
+
+    mColorable = searchHelper(0);
+}
+
+bool MEDTester::TaitColoring::searchHelper(size_t index)
+{
+    while (index < mOrder.size() && mColors[mOrder[index]] != -1) ++index;
+    if (index == mOrder.size()) return true;
+
+    int e = mOrder[index];
+    std::pair<int,int> edge = mGraph.getEdge(e);
+    uint8_t freeColors = ~(mUsedColors[edge.first] | mUsedColors[edge.second]) & 7;
+
+    for (int color = 0; color < 3; ++color) {
+        if (!(freeColors & (1 << color))) continue;
+        size_t trailSize = mTrail.size();
+        if (assignColor(e, color) && searchHelper(index + 1)) return true;
+        undo(trailSize);
+    }
+    return false;
+}
+
+/* Colors the edge and propagates the consequences - once two edges of a vertex are colored, the
+ * color of the third one is forced. Returns false on a conflict, in which case the caller has to
+ * undo the assignments made so far. */
+bool MEDTester::TaitColoring::assignColor(int edgeId, int color)
+{
+    mPending.clear();
+    mPending.emplace_back(edgeId, color);
+
+    while (!mPending.empty()) {
+        int e = mPending.back().first;
+        int c = mPending.back().second;
+        mPending.pop_back();
+
+        if (mColors[e] == c) continue;
+        if (mColors[e] != -1) return false;
+
+        std::pair<int,int> edge = mGraph.getEdge(e);
+        uint8_t bit = 1 << c;
+        if ((mUsedColors[edge.first] | mUsedColors[edge.second]) & bit) return false;
+
+        mColors[e] = c;
+        mUsedColors[edge.first] |= bit;
+        mUsedColors[edge.second] |= bit;
+        mTrail.push_back(e);
+
+        for (int v : {edge.first, edge.second}) {
+            uint8_t used = mUsedColors[v];
+            if (used != 3 && used != 5 && used != 6) continue;
+            int forced = used == 3 ? 2 : (used == 5 ? 1 : 0);
+            for (int i = 0; i < 3; ++i) {
+                int f = mGraph.getEdgeId(v, i);
+                if (mColors[f] == -1) mPending.emplace_back(f, forced);
+            }
+        }
+    }
+    return true;
+}
+
+void MEDTester::TaitColoring::undo(size_t trailSize)
+{
+    while (mTrail.size() > trailSize) {
+        int e = mTrail.back();
+        mTrail.pop_back();
+
+        std::pair<int,int> edge = mGraph.getEdge(e);
+        uint8_t bit = 1 << mColors[e];
+        mUsedColors[edge.first] &= ~bit;
+        mUsedColors[edge.second] &= ~bit;
+        mColors[e] = -1;
+    }
+}